@@ -0,0 +1,306 @@
+#include "domains.h"
+
+#include <algorithm>
+
+namespace gologpp {
+namespace bench {
+
+
+static std::string symbols(const std::string &pfx, unsigned int count)
+{
+	std::string rv;
+	for (unsigned int i = 0; i < count; ++i)
+		rv += (i ? ", " : "") + pfx + std::to_string(i);
+	return rv;
+}
+
+
+static std::string identifier(const std::string &name)
+{
+	std::string rv = name;
+	std::replace(rv.begin(), rv.end(), '-', '_');
+	return rv + "_";
+}
+
+
+static std::string reward_function(const std::string &p)
+{
+	return "number function " + p + "reward() {\n"
+		"	if (" + p + "goal())\n"
+		"		return 100;\n"
+		"	else\n"
+		"		return -1;\n"
+		"}\n\n";
+}
+
+
+
+Workload blocksworld(unsigned int blocks, unsigned int horizon)
+{
+	Workload rv;
+	rv.name = "blocksworld-" + std::to_string(blocks);
+	const std::string p = identifier(rv.name);
+	rv.query_fluent = p + "loc";
+
+	rv.source =
+		"\nsymbol domain " + p + "blocks = {" + symbols("b", blocks) + "}\n"
+		"symbol domain " + p + "locations = " + p + "blocks | {table}\n\n"
+		"symbol fluent " + p + "loc(symbol x) {\n"
+		"domain:\n"
+		"	x in " + p + "blocks;\n"
+		"initially:\n";
+
+	// One tower b0 on b1 on ... on the table
+	for (unsigned int i = 0; i < blocks; ++i)
+		rv.source += "	(b" + std::to_string(i) + ") = "
+			+ (i + 1 < blocks ? "b" + std::to_string(i + 1) : "table") + ";\n";
+
+	rv.source += "}\n\n"
+		"action " + p + "stack(symbol x, symbol y) {\n"
+		"domain:\n"
+		"	x in " + p + "blocks;\n"
+		"	y in " + p + "locations;\n"
+		"precondition:\n"
+		"	  x != y\n"
+		"	& x != table\n"
+		"	& " + p + "loc(x) != y\n"
+		"	& (!exists(symbol z) " + p + "loc(z) == x)\n"
+		"	& (y == table | !exists(symbol z) " + p + "loc(z) == y)\n"
+		"effect:\n"
+		"	" + p + "loc(x) = y;\n"
+		"}\n\n";
+
+	// Goal is the reversed tower
+	rv.source += "bool function " + p + "goal() {\n"
+		"	return " + p + "loc(b0) == table";
+	for (unsigned int i = 1; i < blocks; ++i)
+		rv.source += " & " + p + "loc(b" + std::to_string(i) + ") == b" + std::to_string(i - 1);
+	rv.source += ";\n}\n\n";
+
+	rv.source += reward_function(p);
+
+	rv.source += "{\n"
+		"	solve(" + std::to_string(horizon) + ", " + p + "reward())\n"
+		"		while (!" + p + "goal())\n"
+		"			pick (symbol x in {" + symbols("b", blocks) + "})\n"
+		"				pick (symbol y in {table, " + symbols("b", blocks) + "})\n"
+		"					" + p + "stack(x, y);\n"
+		"}\n";
+
+	return rv;
+}
+
+
+
+Workload gridworld(unsigned int size, unsigned int horizon)
+{
+	Workload rv;
+	rv.name = "gridworld-" + std::to_string(size);
+	const std::string p = identifier(rv.name);
+	const std::string max = std::to_string(size - 1);
+
+	rv.source = "\n";
+	for (const std::string &coord : { "x", "y" })
+		rv.source += "number fluent " + p + coord + "() {\n"
+			"initially:\n"
+			"	() = 0;\n"
+			"}\n\n";
+
+	struct Move { const char *name, *coord, *op, *bound_op, *bound; };
+	for (const Move &m : {
+		Move { "right", "x", "+", "<", max.c_str() },
+		Move { "left", "x", "-", ">", "0" },
+		Move { "up", "y", "+", "<", max.c_str() },
+		Move { "down", "y", "-", ">", "0" }
+	})
+		rv.source += "action " + p + m.name + "() {\n"
+			"precondition:\n"
+			"	" + p + m.coord + "() " + m.bound_op + " " + m.bound + "\n"
+			"effect:\n"
+			"	" + p + m.coord + "() = " + p + m.coord + "() " + m.op + " 1;\n"
+			"}\n\n";
+
+	rv.source += "bool function " + p + "goal() {\n"
+		"	return (" + p + "x() == " + max + " & " + p + "y() == " + max + ");\n"
+		"}\n\n";
+
+	rv.source += reward_function(p);
+
+	rv.source += "{\n"
+		"	solve(" + std::to_string(horizon) + ", " + p + "reward())\n"
+		"		while (!" + p + "goal())\n"
+		"			choose {\n"
+		"				" + p + "right();\n"
+		"				" + p + "left();\n"
+		"				" + p + "up();\n"
+		"				" + p + "down();\n"
+		"			}\n"
+		"}\n";
+
+	return rv;
+}
+
+
+
+Workload logistics(unsigned int packages, unsigned int cities, unsigned int trucks, unsigned int horizon)
+{
+	Workload rv;
+	rv.name = "logistics-" + std::to_string(packages)
+		+ "-" + std::to_string(cities)
+		+ "-" + std::to_string(trucks);
+	const std::string p = identifier(rv.name);
+	const std::string last_city = "c" + std::to_string(cities - 1);
+	rv.query_fluent = p + "at";
+
+	rv.source =
+		"\nsymbol domain " + p + "packages = {" + symbols("p", packages) + "}\n"
+		"symbol domain " + p + "cities = {" + symbols("c", cities) + "}\n"
+		"symbol domain " + p + "trucks = {" + symbols("t", trucks) + "}\n"
+		"symbol domain " + p + "places = " + p + "cities | " + p + "trucks\n\n";
+
+	rv.source += "symbol fluent " + p + "at(symbol x) {\n"
+		"domain:\n"
+		"	x in " + p + "packages;\n"
+		"initially:\n";
+	for (unsigned int i = 0; i < packages; ++i)
+		rv.source += "	(p" + std::to_string(i) + ") = c0;\n";
+	rv.source += "}\n\n";
+
+	rv.source += "symbol fluent " + p + "truck_at(symbol t) {\n"
+		"domain:\n"
+		"	t in " + p + "trucks;\n"
+		"initially:\n";
+	for (unsigned int i = 0; i < trucks; ++i)
+		rv.source += "	(t" + std::to_string(i) + ") = c" + std::to_string(i % cities) + ";\n";
+	rv.source += "}\n\n";
+
+	rv.source +=
+		"action " + p + "drive(symbol t, symbol to) {\n"
+		"domain:\n"
+		"	t in " + p + "trucks;\n"
+		"	to in " + p + "cities;\n"
+		"precondition:\n"
+		"	" + p + "truck_at(t) != to\n"
+		"effect:\n"
+		"	" + p + "truck_at(t) = to;\n"
+		"}\n\n"
+		"action " + p + "load(symbol x, symbol t) {\n"
+		"domain:\n"
+		"	x in " + p + "packages;\n"
+		"	t in " + p + "trucks;\n"
+		"precondition:\n"
+		"	" + p + "at(x) == " + p + "truck_at(t)\n"
+		"effect:\n"
+		"	" + p + "at(x) = t;\n"
+		"}\n\n"
+		"action " + p + "unload(symbol x, symbol t) {\n"
+		"domain:\n"
+		"	x in " + p + "packages;\n"
+		"	t in " + p + "trucks;\n"
+		"precondition:\n"
+		"	" + p + "at(x) == t\n"
+		"effect:\n"
+		"	" + p + "at(x) = " + p + "truck_at(t);\n"
+		"}\n\n";
+
+	rv.source += "bool function " + p + "goal() {\n"
+		"	return " + p + "at(p0) == " + last_city;
+	for (unsigned int i = 1; i < packages; ++i)
+		rv.source += " & " + p + "at(p" + std::to_string(i) + ") == " + last_city;
+	rv.source += ";\n}\n\n";
+
+	rv.source += reward_function(p);
+
+	rv.source += "{\n"
+		"	solve(" + std::to_string(horizon) + ", " + p + "reward())\n"
+		"		while (!" + p + "goal())\n"
+		"			pick (symbol t in {" + symbols("t", trucks) + "})\n"
+		"				choose {\n"
+		"					pick (symbol c in {" + symbols("c", cities) + "})\n"
+		"						" + p + "drive(t, c);\n"
+		"					pick (symbol x in {" + symbols("p", packages) + "})\n"
+		"						" + p + "load(x, t);\n"
+		"					pick (symbol x in {" + symbols("p", packages) + "})\n"
+		"						" + p + "unload(x, t);\n"
+		"				}\n"
+		"}\n";
+
+	return rv;
+}
+
+
+
+Workload generated_source(size_t bytes)
+{
+	Workload rv;
+	rv.name = "generated-" + std::to_string(bytes / 1024) + "k";
+	const std::string p = identifier(rv.name);
+
+	for (unsigned int i = 0; rv.source.size() < bytes; ++i) {
+		const std::string n = std::to_string(i);
+		rv.source +=
+			"// Counter " + n + " and the actions that change it\n"
+			"number fluent " + p + "count" + n + "() {\n"
+			"initially:\n"
+			"	() = " + n + ";\n"
+			"}\n\n"
+			"/* Increment counter " + n + " by some amount,\n"
+			" * as long as it stays below its limit. */\n"
+			"action " + p + "inc" + n + "(number by) {\n"
+			"precondition:\n"
+			"	" + p + "count" + n + "() + by < 1000 // the limit\n"
+			"effect:\n"
+			"	" + p + "count" + n + "() = " + p + "count" + n + "() + by;\n"
+			"}\n\n"
+			"procedure " + p + "fill" + n + "() {\n"
+			"	while (" + p + "count" + n + "() < 900)\n"
+			"		" + p + "inc" + n + "(10);\n"
+			"}\n\n";
+	}
+
+	rv.source += "{\n"
+		"	" + p + "fill0();\n"
+		"}\n";
+
+	return rv;
+}
+
+
+
+Workload generated_map(unsigned int locations)
+{
+	Workload rv;
+	rv.name = "map-" + std::to_string(locations);
+	const std::string p = identifier(rv.name);
+	rv.query_fluent = p + "next";
+
+	rv.source =
+		"symbol domain " + p + "locations = {" + symbols("l", locations) + "}\n\n"
+		"symbol fluent " + p + "next(symbol l) {\n"
+		"initially:\n";
+	for (unsigned int i = 0; i < locations; ++i)
+		rv.source += "	(l" + std::to_string(i) + ") = l" + std::to_string((i + 1) % locations) + ";\n";
+	rv.source += "}\n";
+
+	return rv;
+}
+
+
+
+std::vector<Workload> default_workloads()
+{
+	return {
+		blocksworld(3, 4),
+		blocksworld(8, 2),
+		blocksworld(16, 1),
+		gridworld(4, 4),
+		gridworld(16, 2),
+		logistics(2, 3, 1, 4),
+		logistics(8, 6, 3, 2),
+		logistics(16, 8, 4, 1)
+	};
+}
+
+
+} // namespace bench
+} // namespace gologpp
@@ -0,0 +1,52 @@
+#ifndef GOLOGPP_BENCH_DOMAINS_H_
+#define GOLOGPP_BENCH_DOMAINS_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace gologpp {
+namespace bench {
+
+
+/**
+ * @brief A generated planning problem, i.e. golog++ source code with a toplevel program that
+ * solves it by decision-theoretic planning.
+ * All global names are prefixed with the workload's name so that several workloads can be
+ * compiled into the same ReadyLog engine.
+ */
+struct Workload {
+	std::string name;
+	std::string source;
+
+	/// Name of a unary fluent to run quantified queries against, or empty if there is none.
+	std::string query_fluent;
+};
+
+
+/// @p blocks blocks stacked into one tower, which has to be reversed.
+Workload blocksworld(unsigned int blocks, unsigned int horizon);
+
+/// A robot on a @p size x @p size grid that has to walk from one corner to the opposite one.
+Workload gridworld(unsigned int size, unsigned int horizon);
+
+/// @p packages packages that have to be driven from the first to the last of @p cities by @p trucks trucks.
+Workload logistics(unsigned int packages, unsigned int cities, unsigned int trucks, unsigned int horizon);
+
+/// At least @p bytes of commented declarations with a trivial program, for measuring the parser alone.
+Workload generated_source(size_t bytes);
+
+/**
+ * @brief A ring of @p locations symbols and a fluent mapping each to the next one, as only declarations
+ * (no program). Meant to compare parsing such generated models to building them with the bulk API.
+ */
+Workload generated_map(unsigned int locations);
+
+/// The default set of workloads in increasing size.
+std::vector<Workload> default_workloads();
+
+
+} // namespace bench
+} // namespace gologpp
+
+#endif // GOLOGPP_BENCH_DOMAINS_H_
@@ -0,0 +1,467 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <list>
+#include <thread>
+#include <cstring>
+
+#include <model/fluent.h>
+#include <model/fluent_extension.h>
+#include <model/domain.h>
+#include <model/formula.h>
+#include <model/reference.h>
+#include <model/procedural.h>
+#include <model/simplification.h>
+#include <model/metrics.h>
+
+#include <parser/parser.h>
+
+#ifdef GOLOGPP_BENCH_READYLOG
+#include <model/history.h>
+#include <semantics/readylog/execution.h>
+#endif
+
+#include "domains.h"
+
+
+using namespace gologpp;
+using namespace gologpp::bench;
+
+
+
+struct Options {
+	string filter;
+	string json_file;
+	double min_time = 0.5;
+	unsigned int min_iterations = 5;
+	bool list = false;
+};
+
+
+
+/**
+ * @brief Runs benchmarks and collects one @ref LatencyHistogram per benchmark.
+ * A benchmark body times only its interesting part by putting an @ref ExecutionMetrics::Timer
+ * on the histogram it's given, so setup and teardown don't count.
+ */
+class Harness {
+public:
+	Harness(const Options &options)
+	: options_(options)
+	{}
+
+	bool enabled(const string &name) const
+	{ return options_.filter.empty() || name.find(options_.filter) != string::npos; }
+
+	void run(const string &name, const std::function<void(LatencyHistogram &)> &body)
+	{
+		if (!enabled(name))
+			return;
+		if (options_.list) {
+			std::cout << name << std::endl;
+			return;
+		}
+
+		LatencyHistogram &h = result(name);
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		std::chrono::duration<double> min_time(options_.min_time);
+		while (h.count() < options_.min_iterations || std::chrono::steady_clock::now() - start < min_time)
+			body(h);
+
+		report(name);
+	}
+
+	/// @return The histogram for @param name, for benchmarks that can only be sampled once.
+	LatencyHistogram &result(const string &name)
+	{
+		for (Result &r : results_)
+			if (r.name == name)
+				return r.histogram;
+		results_.emplace_back();
+		results_.back().name = name;
+		return results_.back().histogram;
+	}
+
+	void report(const string &name)
+	{
+		const LatencyHistogram &h = result(name);
+		std::cout << std::left << std::setw(48) << name << std::right
+			<< std::setw(10) << h.count()
+			<< std::setw(14) << micros(h.mean())
+			<< std::setw(14) << micros(h.percentile(50))
+			<< std::setw(14) << micros(h.percentile(99))
+			<< std::endl;
+	}
+
+	void print_header() const
+	{
+		if (options_.list)
+			return;
+		std::cout << std::left << std::setw(48) << "benchmark" << std::right
+			<< std::setw(10) << "samples"
+			<< std::setw(14) << "mean [us]"
+			<< std::setw(14) << "p50 [us]"
+			<< std::setw(14) << "p99 [us]"
+			<< std::endl;
+	}
+
+	string to_json() const
+	{
+		string rv = "{" linesep
+			+ indent + "\"version\": \"" GOLOGPP_VERSION "\"," linesep
+			+ indent + "\"benchmarks\": {" linesep;
+		for (auto it = results_.begin(); it != results_.end(); ++it) {
+			rv += indent + indent + "\"" + it->name + "\": " + it->histogram.to_json();
+			if (std::next(it) != results_.end())
+				rv += ",";
+			rv += linesep;
+		}
+		return rv + indent + "}" linesep "}" linesep;
+	}
+
+private:
+	static string micros(LatencyHistogram::duration d)
+	{
+		std::ostringstream s;
+		s << std::fixed << std::setprecision(1) << double(d.count()) / 1000;
+		return s.str();
+	}
+
+	struct Result {
+		string name;
+		LatencyHistogram histogram;
+	};
+
+	const Options &options_;
+	std::list<Result> results_;
+};
+
+
+
+static volatile size_t sink;
+
+
+
+static unique_ptr<Expression> parse(const Workload &w)
+{
+	global_scope().clear();
+	unique_ptr<Expression> rv = parser::parse_string(w.source);
+	if (!rv)
+		throw Bug("Failed to parse workload " + w.name);
+	return rv;
+}
+
+
+
+static void bench_model(Harness &harness, const Workload &w)
+{
+	harness.run("parse/" + w.name, [&] (LatencyHistogram &h) {
+		global_scope().clear();
+		unique_ptr<Expression> program;
+		{ ExecutionMetrics::Timer t(h);
+			program = parser::parse_string(w.source);
+		}
+	} );
+
+	harness.run("simplify/" + w.name, [&] (LatencyHistogram &h) {
+		unique_ptr<Expression> program = parse(w);
+		ExecutionMetrics::Timer t(h);
+		sink = simplify(global_scope(), program).size();
+	} );
+
+	if (!harness.enabled("fluent_query/get/" + w.name)
+		&& !harness.enabled("fluent_query/indexed/" + w.name)
+		&& !harness.enabled("fluent_query/scan/" + w.name)
+	)
+		return;
+
+	unique_ptr<Expression> program = parse(w);
+
+	vector<const FluentExtension *> extensions;
+	for (const shared_ptr<Global> &g : global_scope().globals())
+		if (shared_ptr<Fluent> f = std::dynamic_pointer_cast<Fluent>(g))
+			extensions.push_back(&f->extension());
+
+	harness.run("fluent_query/get/" + w.name, [&] (LatencyHistogram &h) {
+		size_t found = 0;
+		{ ExecutionMetrics::Timer t(h);
+			for (const FluentExtension *ext : extensions)
+				for (const FluentExtension::ArgsTuple *args : ext->args())
+					found += ext->get(*args) != nullptr;
+		}
+		sink = found;
+	} );
+
+	if (w.query_fluent.empty())
+		return;
+
+	// exists(symbol z) f(z) == v for every initial value v of the query fluent
+	shared_ptr<Fluent> fluent = global_scope().lookup_global<Fluent>(w.query_fluent, 1);
+	vector<unique_ptr<Quantification>> queries;
+	vector<IndexedQuantification> indexed;
+	for (const unique_ptr<InitialValue> &ival : fluent->initially()) {
+		Scope *q_scope = new Scope(global_scope());
+		shared_ptr<Variable> z = q_scope->get_var(VarDefinitionMode::FORCE, SymbolType::name(), "z");
+		queries.emplace_back(new Quantification(
+			q_scope,
+			QuantificationOperator::EXISTS,
+			z,
+			new Comparison(fluent->make_ref({ z->ref() }), ComparisonOperator::EQ, ival->value().copy())
+		));
+		indexed.emplace_back();
+		if (!IndexedQuantification::match(*queries.back(), indexed.back()))
+			throw Bug("Not an indexed quantification: " + queries.back()->str());
+	}
+
+	const FluentExtension &ext = fluent->extension();
+
+	harness.run("fluent_query/indexed/" + w.name, [&] (LatencyHistogram &h) {
+		size_t found = 0;
+		{ ExecutionMetrics::Timer t(h);
+			for (const IndexedQuantification &q : indexed)
+				found += q.evaluate(ext);
+		}
+		sink = found;
+	} );
+
+	// The same queries answered by testing the fluent's value for every argument tuple
+	harness.run("fluent_query/scan/" + w.name, [&] (LatencyHistogram &h) {
+		size_t found = 0;
+		{ ExecutionMetrics::Timer t(h);
+			for (const IndexedQuantification &q : indexed)
+				for (const FluentExtension::ArgsTuple *args : ext.args())
+					if (*ext.get(*args) == *q.value) {
+						++found;
+						break;
+					}
+		}
+		sink = found;
+	} );
+}
+
+
+
+#ifdef GOLOGPP_BENCH_READYLOG
+
+/**
+ * @brief A @ref PlatformBackend that finishes every activity immediately, so that benchmarks
+ * measure the reasoning and not the simulated execution.
+ */
+class InstantBackend : public PlatformBackend {
+public:
+	virtual Clock::time_point time() const noexcept override
+	{ return Clock::time_point(std::chrono::steady_clock::now().time_since_epoch()); }
+
+private:
+	virtual void execute_activity(shared_ptr<Activity> a) override
+	{ run_activity(a, [] (Activity &, CancellationToken &) { return ActivityResult::finish(); }); }
+};
+
+
+
+/**
+ * All ReadyLog benchmarks are sampled once per workload, since the engine can't forget
+ * what it has compiled. The first transition of each workload program is the solve statement,
+ * i.e. the whole DT planning run. All following transitions execute the resulting policy.
+ */
+static void bench_readylog(Harness &harness, const Workload &w)
+{
+	const string attach_name = "attach_semantics/" + w.name;
+	const string compile_name = "compile/" + w.name;
+	const string solve_name = "solve/" + w.name;
+	const string trans_name = "trans/" + w.name;
+	if (!harness.enabled(attach_name) && !harness.enabled(compile_name)
+		&& !harness.enabled(solve_name) && !harness.enabled(trans_name)
+	)
+		return;
+
+	Expression *mainproc = parse(w).release();
+	ReadylogContext &ctx = ReadylogContext::instance();
+
+	ctx.precompile();
+	{ ExecutionMetrics::Timer t(harness.result(attach_name));
+		for (const shared_ptr<Global> &g : global_scope().globals())
+			std::dynamic_pointer_cast<AbstractLanguageElement>(g)->attach_semantics(ctx.semantics_factory());
+	}
+	{ ExecutionMetrics::Timer t(harness.result(compile_name));
+		for (const shared_ptr<Global> &g : global_scope().globals())
+			g->compile(ctx);
+	}
+	ctx.postcompile();
+
+	Block program(new Scope(global_scope()), { mainproc });
+	History history;
+	history.attach_semantics(ctx.semantics_factory());
+	program.attach_semantics(ctx.semantics_factory());
+	ctx.compile(program);
+
+	auto append_exog = [&] (shared_ptr<Grounding<AbstractAction>> exog) {
+		exog->attach_semantics(ctx.semantics_factory());
+		history.abstract_impl().append_exog(exog);
+	};
+
+	bool solved = false;
+	while (!ctx.final(program, history)) {
+		while (!ctx.exog_empty())
+			append_exog(ctx.exog_queue_pop());
+
+		bool transitioned;
+		{ ExecutionMetrics::Timer t(harness.result(solved ? trans_name : solve_name));
+			transitioned = ctx.trans(program, history);
+		}
+		solved = true;
+
+		if (!transitioned) {
+			append_exog(ctx.exog_queue_poll());
+			continue;
+		}
+
+		shared_ptr<Transition> trans = history.abstract_impl().get_last_transition();
+		if (!trans)
+			continue;
+		if (trans->hook() == Transition::Hook::START)
+			ctx.backend()->start_activity(trans);
+		else if (trans->hook() == Transition::Hook::FINISH && trans->target()->senses())
+			history.abstract_impl().append_sensing_result(ctx.backend()->end_activity(trans));
+		else if (trans->hook() != Transition::Hook::STOP)
+			ctx.backend()->end_activity(trans);
+	}
+
+	for (const string &name : { attach_name, compile_name, solve_name, trans_name })
+		if (harness.enabled(name))
+			harness.report(name);
+}
+
+#endif // GOLOGPP_BENCH_READYLOG
+
+
+
+static void usage(const char *argv0)
+{
+	std::cerr << "Usage: " << argv0 << " [options]" << std::endl
+		<< "  --filter=STRING       Only run benchmarks whose name contains STRING" << std::endl
+		<< "  --json=FILE           Write all results to FILE as JSON" << std::endl
+		<< "  --min-time=SECONDS    Minimum time to spend on each benchmark (default 0.5)" << std::endl
+		<< "  --min-iterations=N    Minimum number of samples for each benchmark (default 5)" << std::endl
+		<< "  --list                Only list the benchmarks that would run" << std::endl;
+}
+
+
+static bool option(const char *arg, const char *name, string &value)
+{
+	size_t len = ::strlen(name);
+	if (::strncmp(arg, name, len) || arg[len] != '=')
+		return false;
+	value = arg + len + 1;
+	return true;
+}
+
+
+
+int main(int argc, const char **argv)
+{
+	Options options;
+	for (int i = 1; i < argc; ++i) {
+		string value;
+		if (option(argv[i], "--filter", value))
+			options.filter = value;
+		else if (option(argv[i], "--json", value))
+			options.json_file = value;
+		else if (option(argv[i], "--min-time", value))
+			options.min_time = std::stod(value);
+		else if (option(argv[i], "--min-iterations", value))
+			options.min_iterations = unsigned(std::stoul(value));
+		else if (!::strcmp(argv[i], "--list"))
+			options.list = true;
+		else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	Harness harness(options);
+	harness.print_header();
+
+	vector<Workload> workloads = default_workloads();
+
+	for (const Workload &w : workloads)
+		bench_model(harness, w);
+
+	// The parser on its own, with a source size like that of a big real-world domain
+	Workload generated = generated_source(1024 * 1024);
+	harness.run("parse/" + generated.name, [&] (LatencyHistogram &h) {
+		global_scope().clear();
+		ExecutionMetrics::Timer t(h);
+		sink = bool(parser::parse_string(generated.source));
+	} );
+
+	// A large generated model, parsed from source and built directly with the bulk API
+	const unsigned int map_size = 10000;
+	Workload map = generated_map(map_size);
+	harness.run("parse/" + map.name, [&] (LatencyHistogram &h) {
+		global_scope().clear();
+		ExecutionMetrics::Timer t(h);
+		sink = !parser::parse_definitions(map.source).empty();
+	} );
+	harness.run("build/" + map.name, [&] (LatencyHistogram &h) {
+		global_scope().clear();
+		ExecutionMetrics::Timer t(h);
+
+		vector<Value::Representation> locations, args, values;
+		locations.reserve(map_size);
+		args.reserve(map_size);
+		values.reserve(map_size);
+		for (unsigned int i = 0; i < map_size; ++i) {
+			locations.emplace_back("l" + std::to_string(i));
+			args.emplace_back("l" + std::to_string(i));
+			values.emplace_back("l" + std::to_string((i + 1) % map_size));
+		}
+
+		const Type &symbol = *global_scope().lookup_type_raw(SymbolType::name());
+		global_scope().register_domain(new Domain("locations", symbol, std::move(locations)));
+
+		Scope *fluent_scope = new Scope(global_scope());
+		Fluent *next = global_scope().declare_global<Fluent>(
+			fluent_scope, SymbolType::name(), map.query_fluent,
+			vector<shared_ptr<Variable>> { fluent_scope->get_var(FORCE, SymbolType::name(), "l") }
+		);
+		next->define(std::move(args), std::move(values));
+		sink = next->extension().size() == map_size;
+	} );
+
+#ifdef GOLOGPP_BENCH_READYLOG
+	if (options.list) {
+		for (const Workload &w : workloads)
+			for (const string &name : { "attach_semantics/", "compile/", "solve/", "trans/" })
+				if (harness.enabled(name + w.name))
+					std::cout << name << w.name << std::endl;
+	}
+	else {
+		eclipse_opts eclipse_options;
+		eclipse_options.trace = false;
+		eclipse_options.toplevel = false;
+		eclipse_options.guitrace = false;
+		ReadylogContext::init(eclipse_options, std::make_unique<InstantBackend>());
+
+		for (const Workload &w : workloads)
+			bench_readylog(harness, w);
+
+		ReadylogContext::shutdown();
+	}
+#endif
+
+	global_scope().clear();
+
+	if (!options.json_file.empty() && !options.list) {
+		std::ofstream out(options.json_file);
+		out << harness.to_json();
+		if (!out.good()) {
+			std::cerr << "Failed to write " << options.json_file << std::endl;
+			return 1;
+		}
+	}
+
+	return 0;
+}
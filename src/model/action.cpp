@@ -2,6 +2,7 @@
 #include "effect_axiom.h"
 #include "execution.h"
 #include "error.h"
+#include "simplification.h"
 #include <string>
 
 namespace gologpp {
@@ -17,17 +18,24 @@ AbstractAction::AbstractAction(
 , ScopeOwner(own_scope)
 {
 	set_type_by_name(VoidType::name());
+	clear_definition();
+}
+
+
+void AbstractAction::clear_definition()
+{
 	set_precondition(new Value(BoolType::name(), true));
+	effects_.clear();
 
 	vector<fusion_wtf_vector<string, Expression *>> default_mapping;
-	for (const shared_ptr<Variable> &param : params)
+	for (const shared_ptr<Variable> &param : params())
 		default_mapping.push_back(
 			fusion_wtf_vector<string, Expression *> {
 				param->name(),
 				new Reference<Variable>(param)
 			}
 		);
-	set_mapping(new ActionMapping(name, default_mapping));
+	set_mapping(new ActionMapping(name(), default_mapping));
 }
 
 
@@ -44,6 +52,13 @@ void AbstractAction::add_effect(AbstractEffectAxiom *effect)
 void AbstractAction::compile(AExecutionContext &ctx)
 { ctx.compile(*this); }
 
+void AbstractAction::simplify(Simplification &s)
+{
+	s.simplify_member(precondition_, *this);
+	for (unique_ptr<AbstractEffectAxiom> &effect : effects_)
+		effect->simplify(s);
+}
+
 
 string AbstractAction::to_string(const string &pfx) const
 {
@@ -127,6 +142,8 @@ void Action::define(
 	boost::optional<Reference<Fluent> *> senses,
 	boost::optional<ActionMapping *> mapping
 ) {
+	clear_definition();
+	senses_.reset();
 	if (precondition)
 		set_precondition(precondition.value());
 	if (effects)
@@ -163,6 +180,7 @@ void ExogAction::define(
 	boost::optional<vector<AbstractEffectAxiom *>> effects,
 	boost::optional<ActionMapping *> mapping
 ) {
+	clear_definition();
 	if (precondition)
 		set_precondition(precondition.value());
 	if (effects)
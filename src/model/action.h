@@ -50,6 +50,7 @@ public:
 	void add_effect(AbstractEffectAxiom *effect);
 
 	virtual void compile(AExecutionContext &ctx) override;
+	virtual void simplify(Simplification &) override;
 	virtual string to_string(const string &pfx) const override;
 
 	const ActionMapping &mapping() const;
@@ -58,6 +59,10 @@ public:
 
 	virtual void attach_semantics(SemanticsFactory &) override;
 
+protected:
+	/// Reset to the definition of an action that was only declared, so that @ref define replaces any previous one.
+	void clear_definition();
+
 private:
 	vector<unique_ptr<AbstractEffectAxiom>> effects_;
 	SafeExprOwner<BoolType> precondition_;
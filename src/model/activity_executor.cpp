@@ -0,0 +1,90 @@
+#include "activity_executor.h"
+#include "logger.h"
+
+#include <algorithm>
+
+namespace gologpp {
+
+
+CancellationToken::CancellationToken()
+: cancelled_(false)
+{}
+
+
+void CancellationToken::cancel()
+{
+	{
+		// Set under the mutex so that a concurrent wait_for can't miss the notification
+		std::lock_guard<std::mutex> locked(mutex_);
+		cancelled_ = true;
+	}
+	cond_.notify_all();
+}
+
+
+bool CancellationToken::cancelled() const
+{ return cancelled_; }
+
+
+
+ActivityExecutor::ActivityExecutor(size_t workers)
+: running_(true)
+{
+	for (size_t i = 0; i < std::max(workers, size_t(1)); ++i)
+		threads_.emplace_back(&ActivityExecutor::run, this);
+}
+
+
+ActivityExecutor::~ActivityExecutor()
+{
+	{
+		std::lock_guard<std::mutex> locked(mutex_);
+		running_ = false;
+	}
+	cond_.notify_all();
+	for (std::thread &t : threads_)
+		t.join();
+}
+
+
+void ActivityExecutor::submit(Job &&job)
+{
+	{
+		std::lock_guard<std::mutex> locked(mutex_);
+		jobs_.push_back(std::move(job));
+	}
+	cond_.notify_one();
+}
+
+
+size_t ActivityExecutor::workers() const
+{ return threads_.size(); }
+
+
+size_t ActivityExecutor::default_workers()
+{ return std::max(size_t(std::thread::hardware_concurrency()), size_t(4)); }
+
+
+void ActivityExecutor::run()
+{
+	std::unique_lock<std::mutex> locked(mutex_);
+	for (;;) {
+		cond_.wait(locked, [&] { return !jobs_.empty() || !running_; });
+		if (jobs_.empty())
+			return;
+
+		Job job = std::move(jobs_.front());
+		jobs_.pop_front();
+		locked.unlock();
+		try {
+			job();
+		} catch (std::exception &e) {
+			log(LogLevel::ERR, [&] (std::ostream &s) { s << "Uncaught exception in activity executor: " << e.what(); });
+		}
+		locked.lock();
+	}
+}
+
+
+
+} // namespace gologpp
@@ -0,0 +1,81 @@
+#ifndef GOLOGPP_ACTIVITY_EXECUTOR_H_
+#define GOLOGPP_ACTIVITY_EXECUTOR_H_
+
+#include "gologpp.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace gologpp {
+
+
+/**
+ * @brief Tells a running activity that it has been preempted.
+ * Long-running action code should either poll @ref cancelled or sleep with @ref wait_for,
+ * which returns early on cancellation.
+ */
+class CancellationToken {
+public:
+	CancellationToken();
+
+	void cancel();
+	bool cancelled() const;
+
+	/// Sleep for at most @param d.
+	/// @return Whether the token was cancelled before @param d elapsed.
+	template<class RepT, class PeriodT>
+	bool wait_for(std::chrono::duration<RepT, PeriodT> d)
+	{
+		std::unique_lock<std::mutex> locked(mutex_);
+		return cond_.wait_for(locked, d, [&] { return cancelled(); });
+	}
+
+private:
+	std::atomic_bool cancelled_;
+	std::mutex mutex_;
+	std::condition_variable cond_;
+};
+
+
+
+/**
+ * @brief A fixed pool of worker threads that run jobs in FIFO order.
+ * Since each running activity occupies one worker, the number of workers bounds the number of
+ * activities that make progress at the same time. Further jobs wait in the queue.
+ */
+class ActivityExecutor {
+public:
+	using Job = std::function<void()>;
+
+	ActivityExecutor(size_t workers);
+	ActivityExecutor(const ActivityExecutor &) = delete;
+
+	/// Runs all jobs that are still queued before joining the workers.
+	~ActivityExecutor();
+
+	void submit(Job &&job);
+	size_t workers() const;
+
+	/// @return A sensible default pool size for this machine.
+	static size_t default_workers();
+
+private:
+	void run();
+
+	std::mutex mutex_;
+	std::condition_variable cond_;
+	std::deque<Job> jobs_;
+	bool running_;
+	vector<std::thread> threads_;
+};
+
+
+
+} // namespace gologpp
+
+#endif // GOLOGPP_ACTIVITY_EXECUTOR_H_
@@ -1,5 +1,8 @@
 #include "arithmetic.h"
 #include "error.h"
+#include "value.h"
+
+#include <cmath>
 
 namespace gologpp {
 
@@ -28,6 +31,74 @@ ArithmeticOperation::Operator ArithmeticOperation::op() const
 { return operator_; }
 
 
+/**
+ * Compute @param lhs @param op @param rhs like the ECLiPSe arithmetic would, i.e. integer
+ * operands yield an integer result unless the result of a division isn't integral.
+ * @return false if the operation should be left to the backend, e.g. a division by zero.
+ */
+static bool evaluate(const Number &lhs, ArithmeticOperation::Operator op, const Number &rhs, Number &result)
+{
+	bool integral = lhs.integral && rhs.integral;
+
+	switch (op) {
+	case ArithmeticOperation::ADDITION:
+		result = { integral, lhs.l + rhs.l, lhs.d + rhs.d };
+		return true;
+	case ArithmeticOperation::SUBTRACTION:
+		result = { integral, lhs.l - rhs.l, lhs.d - rhs.d };
+		return true;
+	case ArithmeticOperation::MULTIPLICATION:
+		result = { integral, lhs.l * rhs.l, lhs.d * rhs.d };
+		return true;
+	case ArithmeticOperation::DIVISION:
+		if (rhs.d == 0)
+			return false;
+		if (integral && lhs.l % rhs.l == 0)
+			result = { true, lhs.l / rhs.l, double(lhs.l / rhs.l) };
+		else
+			result = { false, 0, lhs.d / rhs.d };
+		return true;
+	case ArithmeticOperation::POWER:
+		if (integral && rhs.l >= 0) {
+			long p = 1;
+			for (long i = 0; i < rhs.l; ++i)
+				p *= lhs.l;
+			result = { true, p, double(p) };
+		}
+		else
+			result = { false, 0, std::pow(lhs.d, rhs.d) };
+		return true;
+	case ArithmeticOperation::MODULO:
+		if (!integral || rhs.l == 0)
+			return false;
+		// mod/2 in ECLiPSe takes the sign of the divisor
+		result.integral = true;
+		result.l = lhs.l % rhs.l;
+		if (result.l != 0 && (result.l < 0) != (rhs.l < 0))
+			result.l += rhs.l;
+		result.d = double(result.l);
+		return true;
+	}
+	throw Bug("Unhandled ArithmeticOperation");
+}
+
+
+Expression *ArithmeticOperation::simplify(Simplification &s)
+{
+	s.simplify_member(lhs_, *this);
+	s.simplify_member(rhs_, *this);
+
+	Number l, r, result;
+	if (get_number(*lhs_, l) && get_number(*rhs_, r) && evaluate(l, op(), r, result)) {
+		Value *rv = make_value(result);
+		s.record(*this, *rv);
+		return rv;
+	}
+
+	return this;
+}
+
+
 string ArithmeticOperation::to_string(const string &pfx) const
 { return lhs().to_string(pfx) + " " + to_string(op()) + " " + rhs().to_string(pfx); }
 
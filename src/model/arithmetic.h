@@ -4,6 +4,7 @@
 #include "expressions.h"
 #include "language.h"
 #include "scope.h"
+#include "simplification.h"
 
 #include <iostream>
 
@@ -23,6 +24,8 @@ public:
 
 	DEFINE_ATTACH_SEMANTICS_WITH_MEMBERS(*lhs_, *rhs_)
 
+	virtual Expression *simplify(Simplification &) override;
+
 	static std::string to_string(ArithmeticOperation::Operator op)
 	{
 		switch (op) {
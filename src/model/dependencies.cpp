@@ -0,0 +1,110 @@
+#include "dependencies.h"
+#include "reference.h"
+#include "fluent.h"
+#include "action.h"
+#include "procedural.h"
+
+namespace gologpp {
+
+
+DependencyRecorder::DependencyRecorder(SemanticsFactory &target)
+: target_(target)
+{}
+
+
+const DependencyRecorder::FluentSet &DependencyRecorder::fluents_referenced_by(const Global *owner) const
+{
+	static const FluentSet none;
+	auto it = references_.find(owner);
+	return it == references_.end() ? none : it->second.fluents;
+}
+
+
+const DependencyRecorder::FluentSet &DependencyRecorder::program_fluents()
+{
+	if (!program_fluents_valid_) {
+		program_fluents_.clear();
+		std::unordered_set<const Global *> visited { nullptr };
+		vector<const Global *> todo { nullptr };
+		while (!todo.empty()) {
+			auto it = references_.find(todo.back());
+			todo.pop_back();
+			if (it == references_.end())
+				continue;
+			program_fluents_.insert(it->second.fluents.begin(), it->second.fluents.end());
+			for (const Global *g : it->second.globals)
+				if (visited.insert(g).second)
+					todo.push_back(g);
+		}
+		program_fluents_valid_ = true;
+	}
+	return program_fluents_;
+}
+
+
+bool DependencyRecorder::complete() const
+{ return complete_; }
+
+
+void DependencyRecorder::forget(const Global *owner)
+{
+	references_.erase(owner);
+	program_fluents_valid_ = false;
+}
+
+
+void DependencyRecorder::record(Reference<Fluent> &ref)
+{ record(ref, ref.target().get()); }
+
+void DependencyRecorder::record(Reference<Function> &ref)
+{ record(ref, ref.target().get()); }
+
+void DependencyRecorder::record(Reference<Action> &ref)
+{ record(ref, ref.target().get()); }
+
+
+void DependencyRecorder::record(const Expression &ref, const Fluent *target)
+{
+	if (!ref.parent()) {
+		complete_ = false;
+		return;
+	}
+	references_[owner(ref)].fluents.insert(target);
+	program_fluents_valid_ = false;
+}
+
+
+void DependencyRecorder::record(const Expression &ref, const Global *target)
+{
+	if (!ref.parent()) {
+		complete_ = false;
+		return;
+	}
+	references_[owner(ref)].globals.insert(target);
+	program_fluents_valid_ = false;
+}
+
+
+const Global *DependencyRecorder::owner(const Expression &ref)
+{
+	// The innermost scope owned by a global, or the global scope if the reference is in the program
+	const Global *rv = nullptr;
+	const Scope *scope = &ref.parent_scope();
+	while (!(rv = dynamic_cast<const Global *>(scope->owner())) && &scope->parent_scope() != scope)
+		scope = &scope->parent_scope();
+	return rv;
+}
+
+
+#define GOLOGPP_DEFINE_RECORDING_MAKE_SEMANTICS(r, data, T) \
+	unique_ptr<AbstractSemantics> DependencyRecorder::make_semantics(T &elem) \
+	{ \
+		record(elem); \
+		return target_.make_semantics(elem); \
+	}
+
+BOOST_PP_SEQ_FOR_EACH(GOLOGPP_DEFINE_RECORDING_MAKE_SEMANTICS, (), GOLOGPP_SEMANTIC_TYPES)
+
+
+
+} // namespace gologpp
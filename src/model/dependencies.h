@@ -0,0 +1,69 @@
+#ifndef GOLOGPP_DEPENDENCIES_H_
+#define GOLOGPP_DEPENDENCIES_H_
+
+#include "gologpp.h"
+#include "semantics.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+namespace gologpp {
+
+
+/**
+ * @brief A @ref SemanticsFactory that forwards to another one and records which globals the code
+ * of each global refers to while semantics are attached.
+ * References in the code of a global are attributed to that global, all others to the program.
+ */
+class DependencyRecorder : public SemanticsFactory {
+public:
+	using FluentSet = std::unordered_set<const Fluent *>;
+
+	DependencyRecorder(SemanticsFactory &target);
+
+	/// @return The fluents referenced directly in the code of @param owner, nullptr for the program.
+	const FluentSet &fluents_referenced_by(const Global *owner) const;
+
+	/// @return All fluents that the program may refer to, including those in any function or action it uses.
+	const FluentSet &program_fluents();
+
+	/// @return False if some reference couldn't be attributed, so the recorded sets may be incomplete.
+	bool complete() const;
+
+	/// Drop what was recorded for the code of @param owner, e.g. before its new definition is attached.
+	void forget(const Global *owner);
+
+	#define GOLOGPP_DECLARE_RECORDING_MAKE_SEMANTICS(r, data, T) \
+		virtual unique_ptr<AbstractSemantics> make_semantics(T &) override;
+
+	BOOST_PP_SEQ_FOR_EACH(GOLOGPP_DECLARE_RECORDING_MAKE_SEMANTICS, (), GOLOGPP_SEMANTIC_TYPES)
+
+private:
+	template<class T>
+	void record(T &)
+	{}
+
+	void record(Reference<Fluent> &ref);
+	void record(Reference<Function> &ref);
+	void record(Reference<Action> &ref);
+	void record(const Expression &ref, const Fluent *target);
+	void record(const Expression &ref, const Global *target);
+	const Global *owner(const Expression &ref);
+
+	struct References {
+		FluentSet fluents;
+		std::unordered_set<const Global *> globals; ///< Functions and actions
+	};
+
+	SemanticsFactory &target_;
+	std::unordered_map<const Global *, References> references_;
+	FluentSet program_fluents_;
+	bool program_fluents_valid_ = false;
+	bool complete_ = true;
+};
+
+
+
+} // namespace gologpp
+
+#endif // GOLOGPP_DEPENDENCIES_H_
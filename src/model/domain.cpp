@@ -11,6 +11,14 @@ Domain::Domain(const string &name, const string &type_name, const vector<Value *
 	add_elements(elements);
 }
 
+Domain::Domain(const string &name, const Type &type, vector<Value::Representation> &&elements, bool implicit)
+: Name(name)
+, implicit_(implicit)
+{
+	set_type(type);
+	add_elements(std::move(elements));
+}
+
 Domain::Domain(const string &type_name)
 : Domain("~unnamed~", type_name, {}, true)
 {}
@@ -111,6 +119,14 @@ void Domain::add_elements(const Domain &other)
 }
 
 
+void Domain::add_elements(vector<Value::Representation> &&elements)
+{
+	elements_.reserve(elements_.size() + elements.size());
+	for (Value::Representation &repr : elements)
+		elements_.emplace(new Value(type(), std::move(repr)));
+}
+
+
 void Domain::remove(const Domain &other)
 {
 	ensure_type(other.type());
@@ -32,6 +32,9 @@ public:
 	typedef typename ElementSet::iterator ElementIterator;
 
 	Domain(const string &name, const string &type_name, const vector<Value *> &elements = {}, bool implicit = false);
+
+	/// Construct a domain of an already resolved @param type from generated @param elements, see @ref add_elements.
+	Domain(const string &name, const Type &type, vector<Value::Representation> &&elements, bool implicit = false);
 	Domain(const string &type_name);
 	Domain(const string &name, const Domain &other);
 	Domain(const Domain &other);
@@ -66,6 +69,13 @@ public:
 	void add_elements(const vector<Value *> &elements);
 	void add_elements(const Domain &other);
 
+	/**
+	 * @brief Add one element of this domain's type for each of the @param elements, e.g. symbols generated
+	 * by another program. The element set is sized once and the type isn't looked up per element, but
+	 * the representations are also not checked against it.
+	 */
+	void add_elements(vector<Value::Representation> &&elements);
+
 	void remove(const Domain &other);
 
 	template<class DefinitionT>
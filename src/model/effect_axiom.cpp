@@ -1,5 +1,6 @@
 #include "effect_axiom.h"
 #include "action.h"
+#include "simplification.h"
 
 namespace gologpp {
 
@@ -32,4 +33,7 @@ void AbstractEffectAxiom::set_condition(Expression *condition)
 	condition_->set_parent(this);
 }
 
+void AbstractEffectAxiom::simplify(Simplification &s)
+{ s.simplify_member(condition_, *this); }
+
 } // namespace gologpp
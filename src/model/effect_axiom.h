@@ -31,6 +31,8 @@ public:
 	Expression &condition();
 	void set_condition(Expression *condition);
 
+	virtual void simplify(Simplification &);
+
 protected:
 	AbstractAction *action_;
 	SafeExprOwner<BoolType> condition_;
@@ -81,6 +83,12 @@ public:
 
 	DEFINE_ATTACH_SEMANTICS_WITH_MEMBERS(*condition_, *assignment_)
 
+	virtual void simplify(Simplification &s) override
+	{
+		AbstractEffectAxiom::simplify(s);
+		assignment_->simplify(s);
+	}
+
 protected:
 	unique_ptr<Assignment<LhsT>> assignment_;
 };
@@ -5,6 +5,7 @@
 #include "expressions.h"
 
 #include <exception>
+#include <stdexcept>
 #include <string>
 
 namespace gologpp {
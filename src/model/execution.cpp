@@ -5,27 +5,61 @@
 #include "history.h"
 #include "platform_backend.h"
 #include "transition.h"
+#include "logger.h"
 
-#include <iostream>
+#include <fstream>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 
 namespace gologpp {
 
 
+AExecutionContext::ThreadBinding::ThreadBinding(AExecutionContext &ctx)
+: scope_guard_(ctx.global_scope())
+, previous_clock_source_(Clock::thread_clock_source)
+{ Clock::thread_clock_source = ctx.backend().get(); }
+
+AExecutionContext::ThreadBinding::~ThreadBinding()
+{ Clock::thread_clock_source = previous_clock_source_; }
+
+
+
 AExecutionContext::AExecutionContext(unique_ptr<SemanticsFactory> &&semantics, unique_ptr<PlatformBackend> &&platform_backend)
-: platform_backend_(move(platform_backend))
+: global_scope_(gologpp::global_scope())
+, platform_backend_(move(platform_backend))
 , semantics_(std::move(semantics))
+, dependencies_(*semantics_)
 {
 	if (!platform_backend_)
 		platform_backend_ = std::make_unique<DummyBackend>();
 	platform_backend_->set_context(this);
 	Clock::clock_source = platform_backend_.get();
+	wakeup_write_fd_ = -1;
+}
+
+
+AExecutionContext::~AExecutionContext()
+{
+	if (!metrics_file_.empty()) {
+		std::ofstream out(metrics_file_);
+		if (out)
+			out << metrics_.to_json();
+		else
+			log(LogLevel::ERR, [&] (std::ostream &s) { s << "Failed to write execution metrics to " << metrics_file_; });
+	}
+
+	for (int fd : wakeup_pipe_)
+		if (fd >= 0)
+			::close(fd);
 }
 
 
 shared_ptr<Grounding<AbstractAction>> AExecutionContext::exog_queue_pop()
 {
-	std::lock_guard<std::mutex> { exog_mutex_ };
+	std::lock_guard<std::mutex> locked(exog_mutex_);
 	shared_ptr<Grounding<AbstractAction>> rv = std::move(exog_queue_.front());
 	exog_queue_.pop();
 	return rv;
@@ -34,22 +68,66 @@ shared_ptr<Grounding<AbstractAction>> AExecutionContext::exog_queue_pop()
 
 shared_ptr<Grounding<AbstractAction>> AExecutionContext::exog_queue_poll()
 {
-	std::unique_lock<std::mutex> queue_empty_lock { queue_empty_mutex_ };
-	queue_empty_condition_.wait(queue_empty_lock, [&] { return !exog_queue_.empty(); });
+	exog_queue_wait();
 	return exog_queue_pop();
 }
 
 
+void AExecutionContext::exog_queue_wait()
+{
+	std::unique_lock<std::mutex> queue_empty_lock { queue_empty_mutex_ };
+	queue_empty_condition_.wait(queue_empty_lock, [&] { return !exog_empty(); });
+}
+
+
 void AExecutionContext::exog_queue_push(shared_ptr<Grounding<AbstractAction>> exog)
 {
-	std::lock_guard<std::mutex> { exog_mutex_ };
-	exog_queue_.push(std::move(exog));
 	{
-		std::lock_guard<std::mutex> { queue_empty_mutex_ };
+		std::lock_guard<std::mutex> locked(exog_mutex_);
+		exog_queue_.push(std::move(exog));
+	}
+	{
+		std::lock_guard<std::mutex> locked(queue_empty_mutex_);
 		queue_empty_condition_.notify_one();
 	}
+
+	int fd = wakeup_write_fd_.load();
+	if (fd >= 0) {
+		// Nonblocking: If the pipe is full, the reader has enough to wake up anyways
+		char c = 0;
+		ssize_t rv = ::write(fd, &c, 1);
+		(void)rv;
+	}
+	if (wakeup_callback_)
+		wakeup_callback_();
+}
+
+
+int AExecutionContext::wakeup_fd()
+{
+	std::call_once(wakeup_pipe_created_, [&] {
+		if (::pipe(wakeup_pipe_))
+			throw EngineError(string("Failed to create wakeup pipe: ") + ::strerror(errno));
+		for (int fd : wakeup_pipe_)
+			::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+		wakeup_write_fd_ = wakeup_pipe_[1];
+	} );
+	return wakeup_pipe_[0];
 }
 
+
+void AExecutionContext::drain_wakeup_fd()
+{
+	if (wakeup_write_fd_.load() < 0)
+		return;
+	char buf[64];
+	while (::read(wakeup_pipe_[0], buf, sizeof(buf)) > 0);
+}
+
+
+void AExecutionContext::set_wakeup_callback(std::function<void ()> &&callback)
+{ wakeup_callback_ = std::move(callback); }
+
 bool AExecutionContext::exog_empty()
 {
 	std::lock_guard<std::mutex> l(exog_mutex_);
@@ -59,9 +137,72 @@ bool AExecutionContext::exog_empty()
 SemanticsFactory &AExecutionContext::semantics_factory()
 { return *semantics_; }
 
+Scope &AExecutionContext::global_scope()
+{ return global_scope_; }
+
+DependencyRecorder &AExecutionContext::dependencies()
+{ return dependencies_; }
+
+bool AExecutionContext::blocking_fluents(Block &, History &, DependencyRecorder::FluentSet &fluents)
+{
+	if (!dependencies().complete())
+		return false;
+	fluents = dependencies().program_fluents();
+	return true;
+}
+
+void AExecutionContext::implement_globals()
+{
+	if (!globals_implemented_) {
+		global_scope().implement_globals(dependencies(), *this);
+		globals_implemented_ = true;
+	}
+}
+
+void AExecutionContext::redefine(Global &global)
+{
+	if (dynamic_cast<const Fluent *>(&global))
+		throw UserError("Cannot redefine fluent " + global.signature_str() + " during execution");
+
+	ThreadBinding binding(*this);
+
+	retract(global);
+	global.set_implementation(nullptr);
+	dependencies().forget(&global);
+
+	precompile();
+	global.attach_semantics(dependencies());
+	global.compile(*this);
+	postcompile();
+}
+
+void AExecutionContext::retract(const Global &)
+{}
+
 unique_ptr<PlatformBackend> &AExecutionContext::backend()
 { return platform_backend_;}
 
+ExecutionMetrics &AExecutionContext::metrics()
+{ return metrics_; }
+
+const ExecutionMetrics &AExecutionContext::metrics() const
+{ return metrics_; }
+
+void AExecutionContext::set_metrics_file(const string &filename)
+{ metrics_file_ = filename; }
+
+void AExecutionContext::set_trace_recorder(unique_ptr<TraceRecorder> &&recorder)
+{ trace_recorder_ = std::move(recorder); }
+
+TraceRecorder *AExecutionContext::trace_recorder()
+{ return trace_recorder_.get(); }
+
+void AExecutionContext::set_trace_replay(unique_ptr<TraceReplay> &&replay)
+{ trace_replay_ = std::move(replay); }
+
+TraceReplay *AExecutionContext::trace_replay()
+{ return trace_replay_.get(); }
+
 
 
 ExecutionContext::ExecutionContext(unique_ptr<SemanticsFactory> &&semantics, unique_ptr<PlatformBackend> &&exec_backend)
@@ -74,49 +215,155 @@ ExecutionContext::~ExecutionContext()
 Clock::time_point ExecutionContext::context_time() const
 { return context_time_; }
 
+bool ExecutionContext::is_final(Block &program, History &history)
+{
+	ExecutionMetrics::Timer t(metrics()[ExecutionMetrics::FINAL]);
+	return final(program, history);
+}
+
+
 History ExecutionContext::run(Block &&program)
 {
-	History history;
-	history.attach_semantics(semantics_factory());
+	ThreadBinding binding(*this);
+
+	start(program);
 
-	global_scope().implement_globals(semantics_factory(), *this);
+	StepResult result;
+	while ((result = step()) != StepResult::FINAL) {
+		if (result == StepResult::WAITING) {
+			log(LogLevel::INF, [] (std::ostream &s) { s << "=== No transition possible: Waiting for exogenous events..."; });
+			exog_queue_wait();
+		}
+	}
 
-	program.attach_semantics(semantics_factory());
+	History rv(std::move(*history_));
+	history_.reset();
+	program_ = nullptr;
+	return rv;
+}
+
+
+void ExecutionContext::start(Block &program)
+{
+	ThreadBinding binding(*this);
+
+	history_.reset(new History());
+	history_->attach_semantics(semantics_factory());
+
+	implement_globals();
+
+	program.attach_semantics(dependencies());
 	compile(program);
 
-	while (!final(program, history)) {
-		context_time_ = backend()->time();
+	program_ = &program;
+	// Number of transitions so far, which is what a trace replay synchronizes on
+	steps_ = 0;
+	blocked_ = false;
+}
+
+
+void ExecutionContext::redefine(Global &global)
+{
+	AExecutionContext::redefine(global);
+	blocked_ = false;
+}
+
+
+ExecutionContext::StepResult ExecutionContext::step()
+{
+	if (!program_)
+		throw Bug("ExecutionContext::step() called without a program, see ExecutionContext::start()");
+
+	ThreadBinding binding(*this);
+	Block &program = *program_;
+	History &history = *history_;
+
+	if (is_final(program, history))
+		return StepResult::FINAL;
+
+	std::chrono::steady_clock::time_point step_start = std::chrono::steady_clock::now();
+	backend()->before_step(steps_);
+	context_time_ = backend()->time();
+
+	if (trace_replay())
+		trace_replay()->feed(*this, steps_);
+
+	bool unblocked = !blocked_;
+	{ ExecutionMetrics::Timer t(metrics()[ExecutionMetrics::EXOG_DRAIN]);
+		// Before looking at the queue, so that no wakeup for a later event is lost
+		drain_wakeup_fd();
 		while (!exog_empty()) {
 			shared_ptr<Grounding<AbstractAction>> exog = exog_queue_pop();
-			std::cout << ">>> Exogenous event: " << exog << std::endl;
+			log(LogLevel::INF, [&] (std::ostream &s) { s << ">>> Exogenous event: " << exog; });
+			if (trace_recorder())
+				trace_recorder()->record(*exog);
 			exog->attach_semantics(semantics_factory());
+			ExecutionMetrics::Timer t(metrics()[ExecutionMetrics::HISTORY_APPEND]);
 			history.abstract_impl().append_exog(exog);
+			unblocked = unblocked || may_unblock(*exog);
 		}
+	}
 
-		if (trans(program, history)) {
-			shared_ptr<Transition> trans = history.abstract_impl().get_last_transition();
-			if (trans) {
-				std::cout << "<<< trans: " << trans->str() << std::endl;
-				if (trans->hook() == Transition::Hook::STOP)
-					backend()->preempt_activity(trans);
-				else if (trans->hook() == Transition::Hook::START)
-					backend()->start_activity(trans);
-				else if (trans->hook() == Transition::Hook::FINISH && trans->target()->senses())
-					history.abstract_impl().append_sensing_result(backend()->end_activity(trans));
-				else
-					backend()->end_activity(trans);
-			}
-		}
-		else {
-			std::cout << "=== No transition possible: Waiting for exogenous events..." << std::endl;
-			shared_ptr<Grounding<AbstractAction>> exog = exog_queue_poll();
-			std::cout << ">>> Exogenous event: " << exog << std::endl;
-			exog->attach_semantics(semantics_factory());
-			history.abstract_impl().append_exog(exog);
+	if (!unblocked)
+		return StepResult::WAITING;
+
+	bool transitioned;
+	{ ExecutionMetrics::Timer t(metrics()[ExecutionMetrics::TRANS]);
+		transitioned = trans(program, history);
+	}
+
+	if (!transitioned) {
+		blocked_ = true;
+		blocking_fluents_.clear();
+		blocking_known_ = blocking_fluents(program, history, blocking_fluents_);
+		return StepResult::WAITING;
+	}
+	blocked_ = false;
+
+	shared_ptr<Transition> trans = history.abstract_impl().get_last_transition();
+	if (trans) {
+		log(LogLevel::INF, [&] (std::ostream &s) { s << "<<< trans: " << trans->str(); });
+		if (trace_recorder())
+			trace_recorder()->record(*trans);
+		++steps_;
+		ExecutionMetrics::Timer t(metrics()[ExecutionMetrics::BACKEND_DISPATCH]);
+		if (trans->hook() == Transition::Hook::STOP)
+			backend()->preempt_activity(trans);
+		else if (trans->hook() == Transition::Hook::START)
+			backend()->start_activity(trans);
+		else if (trans->hook() == Transition::Hook::FINISH && trans->target()->senses()) {
+			shared_ptr<Activity> a = backend()->end_activity(trans);
+			ExecutionMetrics::Timer t(metrics()[ExecutionMetrics::HISTORY_APPEND]);
+			history.abstract_impl().append_sensing_result(a);
 		}
+		else
+			backend()->end_activity(trans);
 	}
+	metrics()[ExecutionMetrics::STEP].record(std::chrono::steady_clock::now() - step_start);
+
+	return StepResult::TRANSITION;
+}
+
 
-	return history;
+bool ExecutionContext::may_unblock(const Grounding<AbstractAction> &exog)
+{
+	// Activities report the state of the program's own actions, so they always count.
+	const Grounding<ExogAction> *event = dynamic_cast<const Grounding<ExogAction> *>(&exog);
+	if (!blocking_known_ || !event)
+		return true;
+
+	for (const Fluent *f : dependencies().fluents_referenced_by(event->target().get()))
+		if (blocking_fluents_.find(f) != blocking_fluents_.end())
+			return true;
+	return false;
+}
+
+
+History &ExecutionContext::history()
+{
+	if (!history_)
+		throw Bug("ExecutionContext::history() called without a program, see ExecutionContext::start()");
+	return *history_;
 }
 
 
@@ -4,15 +4,22 @@
 #include "utilities.h"
 #include "gologpp.h"
 #include "platform_backend.h"
+#include "metrics.h"
+#include "trace.h"
+#include "scope.h"
+#include "dependencies.h"
 
 #include <memory>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <tuple>
 #include <mutex>
 #include <queue>
 #include <condition_variable>
+#include <atomic>
 #include <chrono>
+#include <functional>
 
 namespace gologpp {
 
@@ -22,8 +29,24 @@ class AExecutionContext {
 public:
 	typedef std::queue<shared_ptr<Grounding<AbstractAction>>> ExogQueue;
 
+	/**
+	 * @brief Binds the global scope and the clock of an execution context to the current thread
+	 * while it lives, so that several contexts can run on different threads of one process.
+	 */
+	class ThreadBinding {
+	public:
+		ThreadBinding(AExecutionContext &ctx);
+		ThreadBinding(const ThreadBinding &) = delete;
+		~ThreadBinding();
+
+	private:
+		GlobalScopeGuard scope_guard_;
+		PlatformBackend *previous_clock_source_;
+	};
+
+	/// The context uses the global scope that is bound to the constructing thread, see @ref GlobalScopeGuard.
 	AExecutionContext(unique_ptr<SemanticsFactory> &&implementor, unique_ptr<PlatformBackend> &&platform_backend);
-	virtual ~AExecutionContext() = default;
+	virtual ~AExecutionContext();
 
 	virtual bool final(Block &program, History &h) = 0;
 	virtual bool trans(Block &program, History &h) = 0;
@@ -40,22 +63,93 @@ public:
 
 	virtual History run(Block &&program) = 0;
 
+	/// Attach semantics to and compile all globals. Done by @ref run unless it has been called before.
+	void implement_globals();
+
+	/**
+	 * @brief Attach semantics to and compile only @param global after its definition has been replaced,
+	 * e.g. by @ref parser::parse_definitions. Must not be called while a step is being executed.
+	 * @throw UserError for a fluent, since its value is part of the execution state.
+	 */
+	virtual void redefine(Global &global);
+
+	/**
+	 * @brief Collect the fluents that @param program may be blocked on after @ref trans has failed.
+	 * Exogenous events that can't change any of them don't make the main loop retry @ref trans.
+	 * The default implementation collects every fluent the program may refer to at all.
+	 * @return False if that's unknown, so that every exogenous event causes a retry.
+	 */
+	virtual bool blocking_fluents(Block &program, History &history, DependencyRecorder::FluentSet &fluents);
+
 	shared_ptr<Grounding<AbstractAction>> exog_queue_pop();
 	shared_ptr<Grounding<AbstractAction>> exog_queue_poll();
 	bool exog_empty();
 	void exog_queue_push(shared_ptr<Grounding<AbstractAction>> exog);
 
+	/// Block until the exogenous event queue is not empty.
+	void exog_queue_wait();
+
+	/**
+	 * @brief A file descriptor that becomes readable when an exogenous event is pushed,
+	 * so that an event loop (select/poll/epoll) can wait for it instead of a dedicated thread.
+	 * It is created on the first call and drained by @ref ExecutionContext::step.
+	 */
+	int wakeup_fd();
+
+	/// Call @param callback on the pushing thread after each exogenous event. Set it before execution starts.
+	void set_wakeup_callback(std::function<void ()> &&callback);
+
 	SemanticsFactory &semantics_factory();
 
+	/// @return The global scope that holds the program this context executes.
+	Scope &global_scope();
+
 	unique_ptr<PlatformBackend> &backend();
 
+	/// @return Latency histograms of the phases of the main loop.
+	ExecutionMetrics &metrics();
+	const ExecutionMetrics &metrics() const;
+
+	/// Write @ref metrics as JSON to @param filename when this context is destroyed.
+	void set_metrics_file(const string &filename);
+
+	/// Record everything the main loop processes to a binary trace, see @ref TraceRecorder.
+	void set_trace_recorder(unique_ptr<TraceRecorder> &&recorder);
+	TraceRecorder *trace_recorder();
+
+	/// Feed exogenous events from a recorded trace instead of (or in addition to) the platform.
+	void set_trace_replay(unique_ptr<TraceReplay> &&replay);
+	TraceReplay *trace_replay();
+
+protected:
+	/// Consume pending wakeups from the @ref wakeup_fd.
+	void drain_wakeup_fd();
+
+	/// Attach semantics through this to record the dependencies of the code, see @ref blocking_fluents.
+	DependencyRecorder &dependencies();
+
+	/// Discard what was compiled for the previous definition of @param global. Does nothing by default.
+	virtual void retract(const Global &global);
+
 private:
 	std::mutex exog_mutex_;
 	std::condition_variable queue_empty_condition_;
 	std::mutex queue_empty_mutex_;
 	ExogQueue exog_queue_;
+	Scope &global_scope_;
 	unique_ptr<PlatformBackend> platform_backend_;
 	unique_ptr<SemanticsFactory> semantics_;
+	DependencyRecorder dependencies_;
+	ExecutionMetrics metrics_;
+	string metrics_file_;
+	unique_ptr<TraceRecorder> trace_recorder_;
+	unique_ptr<TraceReplay> trace_replay_;
+	bool globals_implemented_ = false;
+
+	std::once_flag wakeup_pipe_created_;
+	int wakeup_pipe_[2] = { -1, -1 };
+	std::atomic<int> wakeup_write_fd_;
+	std::function<void ()> wakeup_callback_;
 };
 
 
@@ -66,12 +160,50 @@ public:
 
 	virtual ~ExecutionContext() override;
 
+	enum class StepResult {
+		TRANSITION, ///< A transition was taken
+		WAITING, ///< No transition possible until an exogenous event arrives, see @ref wakeup_fd
+		FINAL ///< The program has terminated
+	};
+
+	/// Execute @param program to its end, blocking the calling thread while no transition is possible.
 	virtual History run(Block &&program) override;
 
+	/// Also retry a blocked program, since the new definition may let it continue.
+	virtual void redefine(Global &global) override;
+
+	/**
+	 * @brief Prepare @param program for execution with @ref step.
+	 * @param program Must stay alive until @ref step returns FINAL.
+	 */
+	void start(Block &program);
+
+	/**
+	 * @brief Execute one iteration of the main loop without blocking: Process pending exogenous
+	 * events and take at most one transition. Meant to be called from an event loop whenever
+	 * @ref wakeup_fd becomes readable and repeatedly while it returns TRANSITION.
+	 */
+	StepResult step();
+
+	/// @return The history of the program started with @ref start.
+	History &history();
+
 	Clock::time_point context_time() const;
 
 private:
+	bool is_final(Block &program, History &history);
+
+	/// @return Whether @param exog may change one of the fluents that the blocked program is waiting on.
+	bool may_unblock(const Grounding<AbstractAction> &exog);
+
 	Clock::time_point context_time_;
+	Block *program_ = nullptr;
+	unique_ptr<History> history_;
+	uint64_t steps_ = 0;
+
+	bool blocked_ = false;
+	bool blocking_known_ = false;
+	DependencyRecorder::FluentSet blocking_fluents_;
 };
 
 
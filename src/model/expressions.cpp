@@ -26,6 +26,9 @@ void Expression::set_parent(AbstractLanguageElement *parent)
 const string &Expression::type_name() const
 { return type().name(); }
 
+Expression *Expression::simplify(Simplification &)
+{ return this; }
+
 
 
 }
@@ -31,6 +31,13 @@ public:
 
 	const string &type_name() const;
 
+	/**
+	 * @brief Fold constants and prune dead code in this expression and its children.
+	 * @return Either this, or a replacement expression. If a replacement is returned, the caller
+	 *         takes ownership of it and is responsible for deleting this expression.
+	 */
+	virtual Expression *simplify(Simplification &);
+
 protected:
 	AbstractLanguageElement *parent_;
 };
@@ -92,6 +92,20 @@ const vector<unique_ptr<InitialValue>> &Fluent::initially() const
 void Fluent::define(const vector<InitialValue *> &initial_values)
 { define(boost::optional<vector<InitialValue *>>(initial_values)); }
 
+FluentExtension &Fluent::extension()
+{
+	if (!extension_)
+		throw Bug("Fluent " + signature_str() + " has no extension before it is defined");
+	return *extension_;
+}
+
+const FluentExtension &Fluent::extension() const
+{
+	if (!extension_)
+		throw Bug("Fluent " + signature_str() + " has no extension before it is defined");
+	return *extension_;
+}
+
 Reference<Fluent> *Fluent::make_ref(const vector<Expression *> &args)
 { return make_ref_<Fluent>(args); }
 
@@ -102,16 +116,26 @@ void Fluent::compile(AExecutionContext &ctx)
 { ctx.compile(*this); }
 
 
-void Fluent::define(const boost::optional<vector<InitialValue *>> &initial_values)
+void Fluent::define_implicit_domains()
 {
-	for (shared_ptr<Variable> &arg : params())
-		if (arg->domain().is_implicit())
-			arg->define_implicit_domain("implicit_domain("
+	for (shared_ptr<Variable> &arg : params()) {
+		const string domain_name = "implicit_domain("
 			+ arg->str() + "@" + name() + "/" + std::to_string(arity()) +
-			")");
+			")";
+		// Keep extending the implicit domain if this fluent was already defined
+		if (arg->domain().is_implicit() && arg->domain().name() != domain_name)
+			arg->define_implicit_domain(domain_name);
+	}
+}
+
+
+void Fluent::define(const boost::optional<vector<InitialValue *>> &initial_values)
+{
+	define_implicit_domains();
 
 	if (initial_values) {
 		// TODO: fail if already defined
+		initial_values_.reserve(initial_values_.size() + initial_values->size());
 		for (InitialValue *ival : initial_values.get()) {
 			ensure_type_equality(*this, *ival);
 			if (arity() != ival->args().size())
@@ -129,12 +153,54 @@ void Fluent::define(const boost::optional<vector<InitialValue *>> &initial_value
 
 			initial_values_.push_back(unique_ptr<InitialValue>(ival));
 		}
+		extension_.reset(new FluentExtension(*this));
 	}
 	else
 		throw UserError("Fluent " + signature_str() + ": No `initially:' block");
 }
 
 
+void Fluent::define(vector<Value::Representation> &&args, vector<Value::Representation> &&values)
+{
+	if (args.size() != values.size() * arity())
+		throw UserError("Fluent " + signature_str() + ": Got " + std::to_string(args.size())
+			+ " arguments for " + std::to_string(values.size()) + " initial values");
+
+	define_implicit_domains();
+
+	// Resolve everything per parameter once, not per initial value
+	vector<const Type *> arg_types;
+	vector<Domain *> implicit_domains;
+	for (shared_ptr<Variable> &param : params()) {
+		arg_types.push_back(&param->type());
+		Domain &domain = param->domain();
+		if (domain.is_implicit()) {
+			domain.elements().reserve(domain.elements().size() + values.size());
+			implicit_domains.push_back(&domain);
+		}
+		else
+			implicit_domains.push_back(nullptr);
+	}
+
+	initial_values_.reserve(initial_values_.size() + values.size());
+	auto arg_it = args.begin();
+	for (Value::Representation &value : values) {
+		vector<Value *> ival_args;
+		ival_args.reserve(arity());
+		for (arity_t arg_idx = 0; arg_idx < arity(); ++arg_idx, ++arg_it) {
+			ival_args.push_back(new Value(*arg_types[arg_idx], std::move(*arg_it)));
+			if (implicit_domains[arg_idx])
+				implicit_domains[arg_idx]->elements().emplace(new Value(*ival_args.back()));
+		}
+
+		InitialValue *ival = new InitialValue(ival_args, new Value(type(), std::move(value)));
+		ival->set_fluent(*this);
+		initial_values_.push_back(unique_ptr<InitialValue>(ival));
+	}
+	extension_.reset(new FluentExtension(*this));
+}
+
+
 void Fluent::attach_semantics(SemanticsFactory &implementor)
 {
 	if (semantics_)
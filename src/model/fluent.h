@@ -7,6 +7,7 @@
 #include "global.h"
 #include "reference.h"
 #include "value.h"
+#include "fluent_extension.h"
 
 namespace gologpp {
 
@@ -63,6 +64,21 @@ public:
 	void define(const vector<InitialValue *> &initial_values);
 	void define(const boost::optional<vector<InitialValue *>> &initial_values);
 
+	/**
+	 * @brief Define this fluent from generated data in one call, without going through @ref InitialValue s
+	 * built one by one: The i-th of the @param values is the initial value for the i-th tuple of
+	 * arity() consecutive @param args. The argument and value types are taken from the fluent's
+	 * signature, so the representations must match them.
+	 */
+	void define(vector<Value::Representation> &&args, vector<Value::Representation> &&values);
+
+	/**
+	 * @return The extension of this fluent with an inverse index from values to argument tuples.
+	 * Initialized from the initial values in @ref define.
+	 */
+	FluentExtension &extension();
+	const FluentExtension &extension() const;
+
 	Reference<Fluent> *make_ref(const vector<Expression *> &params);
 	virtual Expression *ref(const vector<Expression *> &params) override;
 
@@ -73,7 +89,10 @@ public:
 	virtual void compile(AExecutionContext &ctx) override;
 
 private:
+	void define_implicit_domains();
+
 	vector<unique_ptr<InitialValue>> initial_values_;
+	unique_ptr<FluentExtension> extension_;
 };
 
 
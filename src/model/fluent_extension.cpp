@@ -0,0 +1,234 @@
+#include "fluent_extension.h"
+#include "fluent.h"
+#include "formula.h"
+#include "reference.h"
+#include "variable.h"
+#include "domain.h"
+
+#include <boost/functional/hash.hpp>
+
+namespace gologpp {
+
+
+const FluentExtension::ArgsSet FluentExtension::no_args_;
+
+
+size_t FluentExtension::ArgsHash::operator () (const ArgsTuple &args) const
+{
+	size_t rv = 0;
+	for (const unique_ptr<Value> &arg : args)
+		boost::hash_combine(rv, arg->hash());
+	return rv;
+}
+
+
+bool FluentExtension::ArgsEqual::operator () (const ArgsTuple &lhs, const ArgsTuple &rhs) const
+{
+	if (lhs.size() != rhs.size())
+		return false;
+	for (size_t i = 0; i < lhs.size(); ++i)
+		if (*lhs[i] != *rhs[i])
+			return false;
+	return true;
+}
+
+
+size_t FluentExtension::ValueHash::operator () (const Value *v) const
+{ return v->hash(); }
+
+bool FluentExtension::ValueEqual::operator () (const Value *lhs, const Value *rhs) const
+{ return *lhs == *rhs; }
+
+
+
+FluentExtension::FluentExtension(const Fluent &fluent)
+: fluent_(fluent)
+{
+	values_.reserve(fluent.initially().size());
+	for (const unique_ptr<InitialValue> &ival : fluent.initially())
+		set(ival->args(), ival->value());
+}
+
+
+const Fluent &FluentExtension::fluent() const
+{ return fluent_; }
+
+
+void FluentExtension::set(const ArgsTuple &args, const Value &value)
+{
+	auto it = values_.find(args);
+	if (it == values_.end())
+		it = values_.emplace(std::piecewise_construct, std::forward_as_tuple(copy(args)), std::tuple<>()).first;
+	else if (*it->second == value)
+		return;
+	else
+		unindex(it->first, *it->second);
+
+	it->second.reset(value.copy());
+
+	auto idx_it = index_.find(&value);
+	if (idx_it == index_.end()) {
+		Value *key = value.copy();
+		idx_it = index_.emplace(
+			std::piecewise_construct,
+			std::forward_as_tuple(key),
+			std::forward_as_tuple(key, ArgsSet())
+		).first;
+	}
+	idx_it->second.second.insert(&it->first);
+}
+
+
+void FluentExtension::unindex(const ArgsTuple &args, const Value &value)
+{
+	auto it = index_.find(&value);
+	it->second.second.erase(&args);
+	if (it->second.second.empty())
+		index_.erase(it);
+}
+
+
+const Value *FluentExtension::get(const ArgsTuple &args) const
+{
+	auto it = values_.find(args);
+	if (it == values_.end())
+		return nullptr;
+	return it->second.get();
+}
+
+
+const FluentExtension::ArgsSet &FluentExtension::args_with(const Value &value) const
+{
+	auto it = index_.find(&value);
+	if (it == index_.end())
+		return no_args_;
+	return it->second.second;
+}
+
+
+size_t FluentExtension::size() const
+{ return values_.size(); }
+
+
+vector<const FluentExtension::ArgsTuple *> FluentExtension::args() const
+{
+	vector<const ArgsTuple *> rv;
+	for (const auto &entry : values_)
+		rv.push_back(&entry.first);
+	return rv;
+}
+
+
+
+static bool match_fluent_ref(
+	const Quantification &q,
+	const Expression &fluent_side,
+	const Expression &value_side,
+	IndexedQuantification &rv
+) {
+	const Reference<Fluent> *ref = dynamic_cast<const Reference<Fluent> *>(&fluent_side);
+	const Value *value = dynamic_cast<const Value *>(&value_side);
+	if (!ref || !value)
+		return false;
+
+	vector<const Value *> args;
+	arity_t var_idx = ref->arity();
+	for (arity_t i = 0; i < ref->arity(); ++i) {
+		const Expression &arg = *ref->args()[i];
+		const Reference<Variable> *var_ref = dynamic_cast<const Reference<Variable> *>(&arg);
+		if (var_ref && var_ref->target().get() == &q.variable()) {
+			if (var_idx != ref->arity())
+				return false;
+			var_idx = i;
+			args.push_back(nullptr);
+		}
+		else if (const Value *arg_value = dynamic_cast<const Value *>(&arg))
+			args.push_back(arg_value);
+		else
+			return false;
+	}
+	if (var_idx == ref->arity())
+		return false;
+
+	rv.fluent = ref->target().get();
+	rv.args = std::move(args);
+	rv.var_idx = var_idx;
+	rv.value = value;
+	return true;
+}
+
+
+bool IndexedQuantification::match(const Quantification &q, IndexedQuantification &rv)
+{
+	const Comparison *cmp = dynamic_cast<const Comparison *>(&q.expression());
+	if (!cmp || (cmp->op() != ComparisonOperator::EQ && cmp->op() != ComparisonOperator::NEQ))
+		return false;
+
+	if (!match_fluent_ref(q, cmp->lhs(), cmp->rhs(), rv)
+		&& !match_fluent_ref(q, cmp->rhs(), cmp->lhs(), rv)
+	)
+		return false;
+
+	rv.quantification = &q;
+	rv.negated = cmp->op() == ComparisonOperator::NEQ;
+	return true;
+}
+
+
+bool IndexedQuantification::matches(const FluentExtension::ArgsTuple &tuple) const
+{
+	for (arity_t i = 0; i < tuple.size(); ++i)
+		if (i != var_idx && *tuple[i] != *args[i])
+			return false;
+	return true;
+}
+
+
+bool IndexedQuantification::evaluate(const FluentExtension &ext) const
+{
+	if (&ext.fluent() != fluent)
+		throw Bug("Cannot evaluate " + quantification->str() + " over the extension of " + ext.fluent().str());
+
+	// Without a domain, the variable ranges over the arguments for which the fluent is defined
+	const Domain &domain = quantification->variable().domain();
+	bool use_domain = domain.is_defined();
+
+	// Number of possible v with f(..., v, ...) == value.
+	// There is at most one matching tuple per v since all other arguments are fixed.
+	size_t count = 0;
+	for (const FluentExtension::ArgsTuple *tuple : ext.args_with(*value)) {
+		if (matches(*tuple) && (!use_domain || domain.elements().count((*tuple)[var_idx]))) {
+			++count;
+			if (quantification->op() == QuantificationOperator::EXISTS && !negated)
+				return true;
+			if (quantification->op() == QuantificationOperator::FORALL && negated)
+				return false;
+		}
+	}
+
+	size_t total;
+	if (use_domain)
+		total = domain.elements().size();
+	else if (args.size() == 1)
+		total = ext.size();
+	else {
+		total = 0;
+		for (const FluentExtension::ArgsTuple *tuple : ext.args())
+			total += matches(*tuple);
+	}
+
+	bool all = count == total;
+	switch (quantification->op()) {
+	case QuantificationOperator::EXISTS:
+		// exists v: f(v) != c  <=>  !forall v: f(v) == c
+		return negated ? !all : false;
+	case QuantificationOperator::FORALL:
+		// forall v: f(v) != c  <=>  !exists v: f(v) == c
+		return negated ? true : all;
+	}
+
+	throw Bug("Unhandled QuantificationOperator");
+}
+
+
+} // namespace gologpp
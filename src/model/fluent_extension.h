@@ -0,0 +1,107 @@
+#ifndef GOLOGPP_FLUENT_EXTENSION_H_
+#define GOLOGPP_FLUENT_EXTENSION_H_
+
+#include "gologpp.h"
+#include "value.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+namespace gologpp {
+
+
+/**
+ * @brief The extension of a @ref Fluent, i.e. its value for every argument tuple, together with
+ * an inverse index from values to the argument tuples that map to them.
+ *
+ * Initialized from the fluent's initial values. Whoever tracks the fluent's state must report
+ * every change through @ref set so that the inverse index stays consistent.
+ */
+class FluentExtension {
+public:
+	using ArgsTuple = vector<unique_ptr<Value>>;
+
+	struct ArgsHash {
+		size_t operator () (const ArgsTuple &args) const;
+	};
+
+	struct ArgsEqual {
+		bool operator () (const ArgsTuple &lhs, const ArgsTuple &rhs) const;
+	};
+
+	struct ValueHash {
+		size_t operator () (const Value *v) const;
+	};
+
+	struct ValueEqual {
+		bool operator () (const Value *lhs, const Value *rhs) const;
+	};
+
+	using ArgsSet = std::unordered_set<const ArgsTuple *>;
+
+	FluentExtension(const Fluent &fluent);
+	FluentExtension(const FluentExtension &) = delete;
+	FluentExtension &operator = (const FluentExtension &) = delete;
+
+	const Fluent &fluent() const;
+
+	/// Set the value for @param args to @param value and update the inverse index.
+	void set(const ArgsTuple &args, const Value &value);
+
+	/// @return The value for @param args, or nullptr if it is undefined.
+	const Value *get(const ArgsTuple &args) const;
+
+	/// @return All argument tuples for which the fluent has the value @param value.
+	const ArgsSet &args_with(const Value &value) const;
+
+	/// @return All argument tuples for which the fluent has a value.
+	vector<const ArgsTuple *> args() const;
+
+	size_t size() const;
+
+private:
+	void unindex(const ArgsTuple &args, const Value &value);
+
+	const Fluent &fluent_;
+	std::unordered_map<ArgsTuple, unique_ptr<Value>, ArgsHash, ArgsEqual> values_;
+
+	// Each key points to the Value owned by its entry, so lookups don't have to copy a Value.
+	std::unordered_map<const Value *, std::pair<unique_ptr<Value>, ArgsSet>, ValueHash, ValueEqual> index_;
+
+	static const ArgsSet no_args_;
+};
+
+
+
+/**
+ * @brief A @ref Quantification that can be answered from a @ref FluentExtension, i.e. one of the form
+ * `exists/forall (T v): f(c1, ..., v, ..., cn) == c' (or `!='), where all ci and c are @ref Value s
+ * and v appears exactly once in the fluent's arguments.
+ * If v has no explicit domain, it ranges over the arguments for which the fluent is defined.
+ */
+struct IndexedQuantification {
+	const Quantification *quantification;
+	const Fluent *fluent;
+	vector<const Value *> args; ///< nullptr at the position of the quantified variable
+	arity_t var_idx;
+	const Value *value;
+	bool negated;
+
+	/// Check whether @param q is of the indexed form and fill in @param rv if so.
+	static bool match(const Quantification &q, IndexedQuantification &rv);
+
+	/// Check whether the fixed arguments of @param tuple match those of the fluent reference.
+	bool matches(const FluentExtension::ArgsTuple &tuple) const;
+
+	/**
+	 * Evaluate against @param ext in time linear in the number of argument tuples that map to
+	 * @a value, instead of the size of the quantified variable's domain.
+	 */
+	bool evaluate(const FluentExtension &ext) const;
+};
+
+
+
+} // namespace gologpp
+
+#endif // GOLOGPP_FLUENT_EXTENSION_H_
@@ -2,6 +2,8 @@
 
 #include "formula.h"
 #include "expressions.h"
+#include "value.h"
+#include "reference.h"
 
 
 namespace gologpp {
@@ -16,6 +18,27 @@ const Expression &Negation::expression() const
 { return *expression_; }
 
 
+Expression *Negation::simplify(Simplification &s)
+{
+	s.simplify_member(expression_, *this);
+
+	bool b;
+	if (get_bool(*expression_, b)) {
+		Value *rv = new Value(BoolType::name(), !b);
+		s.record(*this, *rv);
+		return rv;
+	}
+	else if (expression_->is_a<Negation>()) {
+		// Double negation: take over the inner operand
+		Negation &inner = dynamic_cast<Negation &>(*expression_);
+		s.record(*this, *inner.expression_);
+		return inner.expression_.release();
+	}
+
+	return this;
+}
+
+
 string Negation::to_string(const string &pfx) const
 { return "!" + expression().to_string(pfx); }
 
@@ -40,6 +63,65 @@ const Expression &Comparison::lhs() const
 const Expression &Comparison::rhs() const
 { return *rhs_; }
 
+
+template<class T>
+static bool compare(T lhs, ComparisonOperator op, T rhs)
+{
+	switch (op) {
+	case EQ:
+		return lhs == rhs;
+	case NEQ:
+		return lhs != rhs;
+	case GE:
+		return lhs >= rhs;
+	case GT:
+		return lhs > rhs;
+	case LE:
+		return lhs <= rhs;
+	case LT:
+		return lhs < rhs;
+	}
+	throw Bug("Unhandled ComparisonOperator");
+}
+
+
+Expression *Comparison::simplify(Simplification &s)
+{
+	s.simplify_member(lhs_, *this);
+	s.simplify_member(rhs_, *this);
+
+	boost::optional<bool> result;
+	Number l, r;
+
+	if (get_number(*lhs_, l) && get_number(*rhs_, r)) {
+		if (l.integral && r.integral)
+			result = compare(l.l, op(), r.l);
+		else
+			result = compare(l.d, op(), r.d);
+	}
+	else if (lhs_->is_a<Value>() && rhs_->is_a<Value>() && (op() == EQ || op() == NEQ))
+		result = compare(
+			dynamic_cast<const Value &>(*lhs_) == dynamic_cast<const Value &>(*rhs_),
+			op(),
+			true
+		);
+	else if (lhs_->is_a<Reference<Variable>>() && rhs_->is_a<Reference<Variable>>()) {
+		// A variable always compares equal to itself, whatever it is bound to
+		if (dynamic_cast<const Reference<Variable> &>(*lhs_).target()
+			== dynamic_cast<const Reference<Variable> &>(*rhs_).target()
+		)
+			result = compare(0, op(), 0);
+	}
+
+	if (!result)
+		return this;
+
+	Value *rv = new Value(BoolType::name(), *result);
+	s.record(*this, *rv);
+	return rv;
+}
+
+
 string Comparison::to_string(const string &pfx) const
 { return '(' + lhs().to_string(pfx) + ' ' + gologpp::to_string(op()) + ' ' + rhs().to_string(pfx) + ')'; }
 
@@ -87,6 +169,94 @@ const Expression &BooleanOperation::lhs() const
 const Expression &BooleanOperation::rhs() const
 { return *rhs_; }
 
+
+static bool evaluate(bool lhs, BooleanOperator op, bool rhs)
+{
+	switch (op) {
+	case AND:
+		return lhs && rhs;
+	case OR:
+		return lhs || rhs;
+	case IMPLIES:
+		return !lhs || rhs;
+	case XOR:
+		return lhs != rhs;
+	case IFF:
+		return lhs == rhs;
+	}
+	throw Bug("Unhandled BooleanOperator");
+}
+
+
+Expression *BooleanOperation::simplify(Simplification &s)
+{
+	s.simplify_member(lhs_, *this);
+	s.simplify_member(rhs_, *this);
+
+	bool l, r;
+	bool l_const = get_bool(*lhs_, l);
+	bool r_const = get_bool(*rhs_, r);
+
+	if (l_const && r_const) {
+		Value *rv = new Value(BoolType::name(), evaluate(l, op(), r));
+		s.record(*this, *rv);
+		return rv;
+	}
+	else if (!l_const && !r_const)
+		return this;
+
+	// One operand is constant: Either it decides the whole operation (short circuit),
+	// or the operation reduces to the other operand or its negation.
+	bool c = l_const ? l : r;
+	SafeExprOwner<BoolType> &other = l_const ? rhs_ : lhs_;
+	Expression *rv = this;
+
+	switch (op()) {
+	case AND:
+		if (c)
+			rv = other.get();
+		else
+			rv = new Value(BoolType::name(), false);
+		break;
+	case OR:
+		if (c)
+			rv = new Value(BoolType::name(), true);
+		else
+			rv = other.get();
+		break;
+	case IMPLIES:
+		if (l_const && l)
+			rv = other.get();
+		else if (l_const || r)
+			rv = new Value(BoolType::name(), true);
+		else
+			rv = new Negation(other.get());
+		break;
+	case XOR:
+		if (c)
+			rv = new Negation(other.get());
+		else
+			rv = other.get();
+		break;
+	case IFF:
+		if (c)
+			rv = other.get();
+		else
+			rv = new Negation(other.get());
+		break;
+	}
+
+	if (rv != this) {
+		bool takes_other = rv == other.get() || rv->is_a<Negation>();
+		s.record(*this, *rv);
+		if (takes_other)
+			other.release();
+	}
+
+	return rv;
+}
+
+
 string BooleanOperation::to_string(const string &pfx) const
 { return '(' + lhs().to_string(pfx) + ' ' + gologpp::to_string(op()) + ' ' + rhs().to_string(pfx) + ')'; }
 
@@ -4,6 +4,7 @@
 #include "expressions.h"
 #include "scope.h"
 #include "variable.h"
+#include "simplification.h"
 
 #include <vector>
 #include <memory>
@@ -21,6 +22,7 @@ public:
 
 	DEFINE_ATTACH_SEMANTICS_WITH_MEMBERS(*expression_)
 
+	virtual Expression *simplify(Simplification &) override;
 	virtual string to_string(const string &pfx) const override;
 
 protected:
@@ -48,6 +50,8 @@ public:
 
 	DEFINE_ATTACH_SEMANTICS_WITH_MEMBERS(*lhs_, *rhs_)
 
+	virtual Expression *simplify(Simplification &) override;
+
 protected:
 	unique_ptr<Expression> lhs_;
 	ComparisonOperator op_;
@@ -85,6 +89,7 @@ public:
 
 	DEFINE_ATTACH_SEMANTICS_WITH_MEMBERS(*lhs_, *rhs_)
 
+	virtual Expression *simplify(Simplification &) override;
 	virtual string to_string(const string &pfx) const override;
 
 protected:
@@ -121,6 +126,7 @@ public:
 	const Expression &expression() const;
 
 	DEFINE_ATTACH_SEMANTICS_WITH_MEMBERS(*variable_, *expression_)
+	DEFINE_SIMPLIFY_WITH_MEMBERS(expression_)
 
 	virtual string to_string(const string &pfx) const override;
 
@@ -22,6 +22,14 @@ vector<shared_ptr<Variable>> &Global::params()
 shared_ptr<Variable> Global::parameter(arity_t idx) const
 { return params_[idx]; }
 
+arity_t Global::param_index(const Variable &param) const
+{
+	arity_t idx = 0;
+	while (idx < params_.size() && params_[idx].get() != &param)
+		++idx;
+	return idx;
+}
+
 void Global::set_params(const vector<shared_ptr<Variable>> &args)
 {
 	if (static_cast<arity_t>(args.size()) != arity() &&
@@ -29,6 +37,7 @@ void Global::set_params(const vector<shared_ptr<Variable>> &args)
 	)
 		throw Bug("Cannot change the arity of a Global that is already registered.");
 
+	params_.clear();
 	for (const shared_ptr<Variable> &var : args) {
 		params_.push_back(var);
 		dynamic_cast<Expression *>(var.get())->set_parent(this);
@@ -37,6 +46,10 @@ void Global::set_params(const vector<shared_ptr<Variable>> &args)
 }
 
 
+void Global::simplify(Simplification &)
+{}
+
+
 Reference<Variable> *Global::param_ref(const string &name)
 {
 	for (shared_ptr<Variable> &var : params_)
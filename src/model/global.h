@@ -33,6 +33,11 @@ public:
 	vector<shared_ptr<Variable>> &params();
 	const vector<shared_ptr<Variable>> &params() const;
 	shared_ptr<Variable> parameter(arity_t idx) const;
+
+	/// @return The position of @param param in @ref params, or @ref arity if it isn't a parameter of this global.
+	arity_t param_index(const Variable &param) const;
+
+	/// Replace the parameters, e.g. with those of a new definition (see @ref Scope::define_global).
 	void set_params(const vector<shared_ptr<Variable>> &params);
 
 	Reference<Variable> *param_ref(const string &name);
@@ -40,6 +45,9 @@ public:
 	virtual void compile(AExecutionContext &ctx) = 0;
 	virtual Expression *ref(const vector<Expression *> &params = {}) = 0;
 
+	/// Run a load-time @ref Simplification over the definition of this global.
+	virtual void simplify(Simplification &);
+
 	virtual Scope &parent_scope() override;
 	virtual const Scope &parent_scope() const override;
 
@@ -111,6 +111,8 @@ class SemanticsFactory;
 class AExecutionContext;
 class ExecutionContext;
 
+class Simplification;
+
 class PlatformBackend;
 
 #define GOLOGPP_PREDEFINED_TYPES \
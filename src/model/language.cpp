@@ -10,10 +10,12 @@ namespace gologpp {
 
 AbstractLanguageElement::AbstractLanguageElement(shared_ptr<const UndefinedType> t)
 : type_(t)
+, type_id_(t->id())
 {}
 
 AbstractLanguageElement::AbstractLanguageElement()
-: type_(gologpp::type<UndefinedType>().shared_from_this())
+: type_(predefined_type(Type::Kind::UNDEFINED))
+, type_id_(type_->id())
 {}
 
 bool AbstractLanguageElement::is_ref() const
@@ -37,7 +39,7 @@ void AbstractLanguageElement::set_type_by_name(const string &name)
 	shared_ptr<const Type> desired_type = global_scope().lookup_type(name);
 
 	if (!type())
-		type_ = desired_type;
+		assign_type(desired_type);
 
 	if (type() != *desired_type)
 		throw TypeError("Cannot override type " + type().name() + " of `" + str() + "' with " + name);
@@ -46,18 +48,28 @@ void AbstractLanguageElement::set_type_by_name(const string &name)
 
 void AbstractLanguageElement::set_type(const Type &t)
 {
+	if (type_id_ == t.id())
+		return;
+
 	if (!type())
-		type_ = t.shared_from_this();
+		assign_type(t.shared_from_this());
 
 	if (type() != t)
 		throw TypeError("Cannot override type " + type().name() + " of `" + str() + "' with " + t.name());
 }
 
 
+void AbstractLanguageElement::assign_type(shared_ptr<const Type> t)
+{
+	type_ = std::move(t);
+	type_id_ = type_->id();
+}
+
+
 template<class T>
 void AbstractLanguageElement::ensure_type() {
 	const Type &this_type = type();
-	if (typeid(this_type) != typeid(T))
+	if (!this_type.is<T>())
 		throw TypeError(this->str() + " is not of type " + T::name());
 }
 
@@ -70,7 +82,7 @@ BOOST_PP_SEQ_FOR_EACH(GOLOGPP_INSTANTIATE_ENSURE_TYPE, (), GOLOGPP_TYPES)
 
 void AbstractLanguageElement::ensure_type(const Type &t) {
 	if (!type())
-		type_ = t.shared_from_this();
+		assign_type(t.shared_from_this());
 
 	if (type() && type() != t)
 		throw TypeError(this->str() + " has type " + type().name()
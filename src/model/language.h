@@ -51,6 +51,10 @@ public:
 	void set_type(const Type &t);
 	virtual const Type &type() const;
 
+	/// @return The @ref Type::id of @ref type, cached for constant-time type identity checks.
+	TypeId type_id() const
+	{ return type_id_; }
+
 	// Unambiguous alias name to simplify type resolution for phoenix::bind in the parser
 	Scope &m_scope();
 
@@ -69,7 +73,10 @@ protected:
 	unique_ptr<AbstractSemantics> semantics_;
 
 private:
+	void assign_type(shared_ptr<const Type> t);
+
 	shared_ptr<const Type> type_;
+	TypeId type_id_;
 };
 
 
@@ -82,8 +89,8 @@ public:
 
 	LanguageElement()
 	{
-		if (typeid(TypeT) != typeid(UndefinedType))
-			set_type_by_name(TypeT::name());
+		if (TypeT::static_kind != Type::Kind::UNDEFINED)
+			set_type(*predefined_type(TypeT::static_kind));
 	}
 
 	virtual ~LanguageElement() = default;
@@ -0,0 +1,193 @@
+#include "logger.h"
+#include "error.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace gologpp {
+
+
+string to_string(LogLevel level)
+{
+	switch (level) {
+	case LogLevel::DBG:
+		return "DBG";
+	case LogLevel::INF:
+		return "INF";
+	case LogLevel::NFY:
+		return "NFY";
+	case LogLevel::WRN:
+		return "WRN";
+	case LogLevel::ERR:
+		return "ERR";
+	}
+	throw Bug("Unhandled LogLevel");
+}
+
+
+
+LogSink::~LogSink()
+{}
+
+
+
+StreamSink::StreamSink(std::ostream &stream)
+: stream_(stream)
+{}
+
+void StreamSink::write(LogLevel, string &&msg)
+{
+	std::lock_guard<std::mutex> locked(mutex_);
+	stream_ << msg << '\n';
+	stream_.flush();
+}
+
+
+
+static size_t next_pow2(size_t n)
+{
+	size_t rv = 1;
+	while (rv < n)
+		rv <<= 1;
+	return rv;
+}
+
+
+AsyncSink::AsyncSink(unique_ptr<LogSink> &&target, size_t capacity)
+: target_(std::move(target))
+, slots_(next_pow2(std::max(capacity, size_t(2))))
+, mask_(slots_.size() - 1)
+, enqueue_pos_(0)
+, dequeue_pos_(0)
+, dropped_(0)
+, dropped_reported_(0)
+, running_(true)
+{
+	for (size_t i = 0; i < slots_.size(); ++i)
+		slots_[i].sequence.store(i, std::memory_order_relaxed);
+	thread_ = std::thread(&AsyncSink::run, this);
+}
+
+
+AsyncSink::~AsyncSink()
+{
+	{
+		std::lock_guard<std::mutex> locked(wakeup_mutex_);
+		running_ = false;
+	}
+	wakeup_.notify_one();
+	thread_.join();
+	drain();
+}
+
+
+void AsyncSink::write(LogLevel level, string &&msg)
+{
+	// Bounded MPMC queue after D. Vyukov: A slot is free for the producer at position pos
+	// when its sequence equals pos, and ready for the consumer when it equals pos + 1.
+	size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+	Slot *slot;
+	for (;;) {
+		slot = &slots_[pos & mask_];
+		size_t seq = slot->sequence.load(std::memory_order_acquire);
+		std::ptrdiff_t diff = std::ptrdiff_t(seq) - std::ptrdiff_t(pos);
+		if (diff == 0) {
+			if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0) {
+			dropped_.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		else
+			pos = enqueue_pos_.load(std::memory_order_relaxed);
+	}
+
+	slot->level = level;
+	slot->msg = std::move(msg);
+	slot->sequence.store(pos + 1, std::memory_order_release);
+}
+
+
+bool AsyncSink::pop(LogLevel &level, string &msg)
+{
+	Slot &slot = slots_[dequeue_pos_ & mask_];
+	if (slot.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1)
+		return false;
+
+	level = slot.level;
+	msg = std::move(slot.msg);
+	slot.sequence.store(dequeue_pos_ + mask_ + 1, std::memory_order_release);
+	++dequeue_pos_;
+	return true;
+}
+
+
+void AsyncSink::drain()
+{
+	LogLevel level;
+	string msg;
+	while (pop(level, msg))
+		target_->write(level, std::move(msg));
+
+	size_t dropped = dropped_.load(std::memory_order_relaxed);
+	if (dropped != dropped_reported_) {
+		target_->write(LogLevel::WRN, "Log buffer full: Dropped "
+			+ std::to_string(dropped - dropped_reported_) + " messages");
+		dropped_reported_ = dropped;
+	}
+}
+
+
+void AsyncSink::run()
+{
+	std::unique_lock<std::mutex> locked(wakeup_mutex_);
+	while (running_) {
+		locked.unlock();
+		drain();
+		locked.lock();
+		// Writers don't notify so that they never touch the mutex. Poll instead.
+		wakeup_.wait_for(locked, std::chrono::milliseconds(5), [&] { return !running_; });
+	}
+}
+
+
+size_t AsyncSink::dropped() const
+{ return dropped_.load(std::memory_order_relaxed); }
+
+
+
+Logger &Logger::instance()
+{
+	static Logger logger;
+	return logger;
+}
+
+
+Logger::Logger()
+: level_(LogLevel::INF)
+, sink_(new AsyncSink(unique_ptr<LogSink>(new StreamSink(std::cout))))
+{}
+
+
+void Logger::set_level(LogLevel level)
+{ level_.store(level, std::memory_order_relaxed); }
+
+LogLevel Logger::level() const
+{ return level_.load(std::memory_order_relaxed); }
+
+void Logger::set_sink(unique_ptr<LogSink> &&sink)
+{ sink_ = std::move(sink); }
+
+void Logger::set_sink_after_fork(unique_ptr<LogSink> &&sink)
+{
+	sink_.release();
+	sink_ = std::move(sink);
+}
+
+void Logger::write(LogLevel level, string &&msg)
+{ sink_->write(level, std::move(msg)); }
+
+
+
+} // namespace gologpp
@@ -0,0 +1,147 @@
+#ifndef GOLOGPP_LOGGER_H_
+#define GOLOGPP_LOGGER_H_
+
+#include "gologpp.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace gologpp {
+
+
+enum class LogLevel {
+	DBG, INF, NFY, WRN, ERR
+};
+
+string to_string(LogLevel level);
+
+
+
+/**
+ * @brief Where the @ref Logger puts messages that pass its level.
+ */
+class LogSink {
+public:
+	virtual ~LogSink();
+	virtual void write(LogLevel level, string &&msg) = 0;
+};
+
+
+
+/**
+ * @brief Writes every message synchronously to a std::ostream.
+ */
+class StreamSink : public LogSink {
+public:
+	StreamSink(std::ostream &stream);
+	virtual void write(LogLevel level, string &&msg) override;
+
+private:
+	std::ostream &stream_;
+	std::mutex mutex_;
+};
+
+
+
+/**
+ * @brief Hands messages to a background thread through a bounded lock-free ring buffer,
+ * so that writing a message never blocks on I/O.
+ * When the buffer is full, messages are dropped and the number of dropped messages is
+ * reported once there is room again.
+ */
+class AsyncSink : public LogSink {
+public:
+	/// @param capacity Number of messages that can be buffered. Rounded up to a power of two.
+	AsyncSink(unique_ptr<LogSink> &&target, size_t capacity = 4096);
+	virtual ~AsyncSink() override;
+
+	virtual void write(LogLevel level, string &&msg) override;
+
+	size_t dropped() const;
+
+private:
+	struct Slot {
+		std::atomic<size_t> sequence;
+		LogLevel level;
+		string msg;
+	};
+
+	bool pop(LogLevel &level, string &msg);
+	void drain();
+	void run();
+
+	unique_ptr<LogSink> target_;
+	vector<Slot> slots_;
+	size_t mask_;
+	std::atomic<size_t> enqueue_pos_;
+	size_t dequeue_pos_;
+	std::atomic<size_t> dropped_;
+	size_t dropped_reported_;
+
+	std::atomic_bool running_;
+	std::mutex wakeup_mutex_;
+	std::condition_variable wakeup_;
+	std::thread thread_;
+};
+
+
+
+/**
+ * @brief Process-wide message filter and dispatcher.
+ * Messages below the current level are never formatted, see @ref log.
+ * By default, messages from INF upward go asynchronously to std::cout.
+ */
+class Logger {
+public:
+	static Logger &instance();
+
+	void set_level(LogLevel level);
+	LogLevel level() const;
+
+	bool enabled(LogLevel level) const
+	{ return level >= level_.load(std::memory_order_relaxed); }
+
+	/// Replace the current sink. Must not be called while other threads are logging.
+	void set_sink(unique_ptr<LogSink> &&sink);
+
+	/// Replace the sink in a forked child process. The old sink is leaked since its thread
+	/// (if any) only exists in the parent, so it can't be shut down.
+	void set_sink_after_fork(unique_ptr<LogSink> &&sink);
+
+	void write(LogLevel level, string &&msg);
+
+private:
+	Logger();
+
+	std::atomic<LogLevel> level_;
+	unique_ptr<LogSink> sink_;
+};
+
+
+
+/**
+ * @brief Log a message at @param level. @param format is a callable that writes the message
+ * to the std::ostream it's given. It is only called if the level is enabled, so a disabled
+ * message costs a single relaxed atomic load.
+ */
+template<class FormatT>
+inline void log(LogLevel level, FormatT &&format)
+{
+	Logger &logger = Logger::instance();
+	if (logger.enabled(level)) {
+		std::ostringstream msg;
+		format(msg);
+		logger.write(level, msg.str());
+	}
+}
+
+
+
+} // namespace gologpp
+
+#endif // GOLOGPP_LOGGER_H_
@@ -0,0 +1,181 @@
+#include "metrics.h"
+#include "error.h"
+#include "utilities.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace gologpp {
+
+
+constexpr size_t LatencyHistogram::sub_buckets;
+constexpr size_t LatencyHistogram::num_buckets;
+
+
+LatencyHistogram::LatencyHistogram()
+{ reset(); }
+
+
+size_t LatencyHistogram::bucket_index(uint64_t ns)
+{
+	if (ns < sub_buckets)
+		return size_t(ns);
+
+	unsigned int magnitude = 63 - unsigned(__builtin_clzll(ns));
+	unsigned int shift = magnitude - sub_bucket_bits;
+	size_t sub_bucket = size_t(ns >> shift) - sub_buckets;
+	return (shift + 1) * sub_buckets + sub_bucket;
+}
+
+
+uint64_t LatencyHistogram::bucket_upper_bound(size_t idx)
+{
+	if (idx < sub_buckets)
+		return idx;
+
+	unsigned int shift = unsigned(idx / sub_buckets) - 1;
+	uint64_t top = idx % sub_buckets + sub_buckets;
+	return ((top + 1) << shift) - 1;
+}
+
+
+void LatencyHistogram::record(duration d)
+{
+	uint64_t ns = d.count() > 0 ? uint64_t(d.count()) : 0;
+
+	buckets_[bucket_index(ns)].fetch_add(1, std::memory_order_relaxed);
+	count_.fetch_add(1, std::memory_order_relaxed);
+	sum_.fetch_add(ns, std::memory_order_relaxed);
+
+	uint64_t prev = min_.load(std::memory_order_relaxed);
+	while (ns < prev && !min_.compare_exchange_weak(prev, ns, std::memory_order_relaxed));
+
+	prev = max_.load(std::memory_order_relaxed);
+	while (ns > prev && !max_.compare_exchange_weak(prev, ns, std::memory_order_relaxed));
+}
+
+
+void LatencyHistogram::reset()
+{
+	for (std::atomic<uint64_t> &b : buckets_)
+		b.store(0, std::memory_order_relaxed);
+	count_.store(0, std::memory_order_relaxed);
+	sum_.store(0, std::memory_order_relaxed);
+	min_.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+	max_.store(0, std::memory_order_relaxed);
+}
+
+
+uint64_t LatencyHistogram::count() const
+{ return count_.load(std::memory_order_relaxed); }
+
+LatencyHistogram::duration LatencyHistogram::min() const
+{ return count() ? duration(min_.load(std::memory_order_relaxed)) : duration(0); }
+
+LatencyHistogram::duration LatencyHistogram::max() const
+{ return duration(max_.load(std::memory_order_relaxed)); }
+
+LatencyHistogram::duration LatencyHistogram::mean() const
+{
+	uint64_t n = count();
+	return n ? duration(sum_.load(std::memory_order_relaxed) / n) : duration(0);
+}
+
+
+LatencyHistogram::duration LatencyHistogram::percentile(double p) const
+{
+	uint64_t n = count();
+	if (n == 0)
+		return duration(0);
+
+	uint64_t rank = uint64_t(p / 100 * n + 0.5);
+	if (rank < 1)
+		rank = 1;
+
+	uint64_t seen = 0;
+	for (size_t idx = 0; idx < num_buckets; ++idx) {
+		seen += buckets_[idx].load(std::memory_order_relaxed);
+		if (seen >= rank)
+			return std::min(duration(bucket_upper_bound(idx)), max());
+	}
+	return max();
+}
+
+
+string LatencyHistogram::to_json() const
+{
+	return string("{ ")
+		+ "\"count\": " + std::to_string(count())
+		+ ", \"min_ns\": " + std::to_string(min().count())
+		+ ", \"mean_ns\": " + std::to_string(mean().count())
+		+ ", \"p50_ns\": " + std::to_string(percentile(50).count())
+		+ ", \"p90_ns\": " + std::to_string(percentile(90).count())
+		+ ", \"p99_ns\": " + std::to_string(percentile(99).count())
+		+ ", \"p999_ns\": " + std::to_string(percentile(99.9).count())
+		+ ", \"max_ns\": " + std::to_string(max().count())
+		+ " }";
+}
+
+
+
+ExecutionMetrics::Timer::Timer(LatencyHistogram &histogram)
+: histogram_(histogram)
+, start_(std::chrono::steady_clock::now())
+{}
+
+ExecutionMetrics::Timer::~Timer()
+{ histogram_.record(std::chrono::steady_clock::now() - start_); }
+
+
+LatencyHistogram &ExecutionMetrics::operator [] (Phase p)
+{ return histograms_[p]; }
+
+const LatencyHistogram &ExecutionMetrics::operator [] (Phase p) const
+{ return histograms_[p]; }
+
+
+void ExecutionMetrics::reset()
+{
+	for (LatencyHistogram &h : histograms_)
+		h.reset();
+}
+
+
+string ExecutionMetrics::to_json() const
+{
+	string rv = "{" linesep;
+	for (size_t p = 0; p < NUM_PHASES; ++p) {
+		rv += indent + "\"" + to_string(Phase(p)) + "\": " + histograms_[p].to_json();
+		if (p < NUM_PHASES - 1)
+			rv += ",";
+		rv += linesep;
+	}
+	return rv + "}" linesep;
+}
+
+
+
+string to_string(ExecutionMetrics::Phase p)
+{
+	switch (p) {
+	case ExecutionMetrics::Phase::EXOG_DRAIN:
+		return "exog_drain";
+	case ExecutionMetrics::Phase::TRANS:
+		return "trans";
+	case ExecutionMetrics::Phase::FINAL:
+		return "final";
+	case ExecutionMetrics::Phase::BACKEND_DISPATCH:
+		return "backend_dispatch";
+	case ExecutionMetrics::Phase::HISTORY_APPEND:
+		return "history_append";
+	case ExecutionMetrics::Phase::STEP:
+		return "step";
+	case ExecutionMetrics::Phase::NUM_PHASES:
+		break;
+	}
+	throw Bug("Unhandled ExecutionMetrics::Phase");
+}
+
+
+
+} // namespace gologpp
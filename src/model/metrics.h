@@ -0,0 +1,103 @@
+#ifndef GOLOGPP_METRICS_H_
+#define GOLOGPP_METRICS_H_
+
+#include "gologpp.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace gologpp {
+
+
+/**
+ * @brief Lock-free latency histogram with logarithmic buckets (HDR-style).
+ * Every power of two is split into 2^sub_bucket_bits linear sub-buckets, so the relative error of a
+ * reported percentile is at most 2^-sub_bucket_bits over the whole range of 64 bit nanoseconds.
+ * Recording is wait-free and may happen concurrently with reading.
+ */
+class LatencyHistogram {
+public:
+	using duration = std::chrono::nanoseconds;
+
+	static constexpr unsigned int sub_bucket_bits = 4;
+	static constexpr size_t sub_buckets = size_t(1) << sub_bucket_bits;
+	static constexpr size_t num_buckets = (64 - sub_bucket_bits + 1) * sub_buckets;
+
+	LatencyHistogram();
+
+	void record(duration d);
+	void reset();
+
+	uint64_t count() const;
+	duration min() const;
+	duration max() const;
+	duration mean() const;
+
+	/// @return The smallest recorded latency such that at least @param p percent of all samples are less or equal.
+	duration percentile(double p) const;
+
+	string to_json() const;
+
+private:
+	static size_t bucket_index(uint64_t ns);
+	static uint64_t bucket_upper_bound(size_t idx);
+
+	std::array<std::atomic<uint64_t>, num_buckets> buckets_;
+	std::atomic<uint64_t> count_;
+	std::atomic<uint64_t> sum_;
+	std::atomic<uint64_t> min_;
+	std::atomic<uint64_t> max_;
+};
+
+
+
+/**
+ * @brief Per-phase latency histograms of an @ref AExecutionContext.
+ */
+class ExecutionMetrics {
+public:
+	enum Phase {
+		EXOG_DRAIN, ///< Taking all pending exogenous events off the queue, including their history append
+		TRANS,
+		FINAL,
+		BACKEND_DISPATCH, ///< Handing a transition to the @ref PlatformBackend
+		HISTORY_APPEND,
+		STEP, ///< One iteration of the main loop that performed a transition
+		NUM_PHASES
+	};
+
+	/**
+	 * @brief Records the time from its construction to its destruction in a @ref LatencyHistogram.
+	 */
+	class Timer {
+	public:
+		Timer(LatencyHistogram &histogram);
+		Timer(const Timer &) = delete;
+		~Timer();
+
+	private:
+		LatencyHistogram &histogram_;
+		std::chrono::steady_clock::time_point start_;
+	};
+
+	LatencyHistogram &operator [] (Phase p);
+	const LatencyHistogram &operator [] (Phase p) const;
+
+	void reset();
+
+	string to_json() const;
+
+private:
+	std::array<LatencyHistogram, NUM_PHASES> histograms_;
+};
+
+
+string to_string(ExecutionMetrics::Phase p);
+
+
+
+} // namespace gologpp
+
+#endif // GOLOGPP_METRICS_H_
@@ -0,0 +1,52 @@
+#include "object_pool.h"
+
+#include <algorithm>
+
+namespace gologpp {
+
+
+BlockPool::BlockPool(size_t block_size)
+// Round up so that every block in a slab is suitably aligned for any type
+: block_size_(
+	(std::max(block_size, sizeof(FreeBlock)) + alignof(std::max_align_t) - 1)
+	/ alignof(std::max_align_t) * alignof(std::max_align_t)
+)
+{}
+
+
+void *BlockPool::allocate()
+{
+	std::lock_guard<std::mutex> locked(mutex_);
+	if (!free_) {
+		// Slabs are never freed: Their blocks are recycled through the free list for the whole process lifetime.
+		char *slab = static_cast<char *>(::operator new(block_size_ * blocks_per_slab));
+		for (size_t i = 0; i < blocks_per_slab; ++i)
+			deallocate_unlocked(slab + i * block_size_);
+	}
+	FreeBlock *rv = free_;
+	free_ = rv->next;
+	return rv;
+}
+
+
+void BlockPool::deallocate(void *block)
+{
+	std::lock_guard<std::mutex> locked(mutex_);
+	deallocate_unlocked(block);
+}
+
+
+void BlockPool::deallocate_unlocked(void *block)
+{
+	FreeBlock *b = static_cast<FreeBlock *>(block);
+	b->next = free_;
+	free_ = b;
+}
+
+
+size_t BlockPool::block_size() const
+{ return block_size_; }
+
+
+
+} // namespace gologpp
@@ -0,0 +1,103 @@
+#ifndef GOLOGPP_OBJECT_POOL_H_
+#define GOLOGPP_OBJECT_POOL_H_
+
+#include "gologpp.h"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+
+namespace gologpp {
+
+
+/**
+ * @brief A thread-safe free list of memory blocks of one size.
+ * Blocks are carved from larger slabs and kept for reuse when they are freed, so objects that
+ * are created and destroyed in every iteration of the main loop don't hit the heap in steady state.
+ */
+class BlockPool {
+public:
+	explicit BlockPool(size_t block_size);
+	BlockPool(const BlockPool &) = delete;
+
+	void *allocate();
+	void deallocate(void *block);
+
+	size_t block_size() const;
+
+	/**
+	 * @brief The pool for blocks of @tparam Size bytes. It's never destroyed, so that objects
+	 * which outlive static destruction can still be freed.
+	 */
+	template<size_t Size>
+	static BlockPool &instance()
+	{
+		static BlockPool *pool = new BlockPool(Size);
+		return *pool;
+	}
+
+private:
+	struct FreeBlock {
+		FreeBlock *next;
+	};
+
+	void deallocate_unlocked(void *block);
+
+	static constexpr size_t blocks_per_slab = 64;
+
+	const size_t block_size_;
+	std::mutex mutex_;
+	FreeBlock *free_ = nullptr;
+};
+
+
+
+/// STL allocator that takes single objects from a @ref BlockPool, e.g. for std::allocate_shared.
+template<class T>
+class PoolAllocator {
+public:
+	using value_type = T;
+
+	PoolAllocator() = default;
+
+	template<class U>
+	PoolAllocator(const PoolAllocator<U> &)
+	{}
+
+	T *allocate(size_t n)
+	{
+		if (n == 1)
+			return static_cast<T *>(BlockPool::instance<sizeof(T)>().allocate());
+		return static_cast<T *>(::operator new(n * sizeof(T)));
+	}
+
+	void deallocate(T *p, size_t n)
+	{
+		if (n == 1)
+			BlockPool::instance<sizeof(T)>().deallocate(p);
+		else
+			::operator delete(p);
+	}
+
+	template<class U>
+	bool operator == (const PoolAllocator<U> &) const
+	{ return true; }
+
+	template<class U>
+	bool operator != (const PoolAllocator<U> &) const
+	{ return false; }
+};
+
+
+
+/// Like std::make_shared, but object and control block come from a @ref BlockPool.
+template<class T, class... ArgTs>
+shared_ptr<T> make_pooled(ArgTs &&... args)
+{ return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<ArgTs>(args)...); }
+
+
+
+} // namespace gologpp
+
+#endif // GOLOGPP_OBJECT_POOL_H_
@@ -1,17 +1,19 @@
 #include "platform_backend.h"
 #include "execution.h"
 #include "transition.h"
+#include "fluent.h"
+#include "logger.h"
 
 #include <thread>
-#include <iostream>
 #include <tuple>
 
 namespace gologpp {
 
 PlatformBackend *Clock::clock_source = nullptr;
+thread_local PlatformBackend *Clock::thread_clock_source = nullptr;
 
 Clock::time_point Clock::now() noexcept
-{ return clock_source->time(); }
+{ return (thread_clock_source ? thread_clock_source : clock_source)->time(); }
 
 
 static Activity::State trans2state(Transition::Hook hook) {
@@ -29,26 +31,87 @@ static Activity::State trans2state(Transition::Hook hook) {
 }
 
 
-PlatformBackend::~PlatformBackend()
+ActivityResult ActivityResult::finish(SensingResult &&sensing_result)
+{ return ActivityResult { Transition::Hook::FINISH, std::move(sensing_result) }; }
+
+ActivityResult ActivityResult::fail()
+{ return ActivityResult { Transition::Hook::FAIL, SensingResult() }; }
+
+ActivityResult ActivityResult::stop()
+{ return ActivityResult { Transition::Hook::STOP, SensingResult() }; }
+
+
+
+ActivityTable::ActivityTable()
+: next_id_(1)
 {}
 
+
+void ActivityTable::insert(const shared_ptr<Activity> &a)
+{
+	size_t shard_idx = a->hash() & (num_shards - 1);
+	a->set_activity_id((next_id_.fetch_add(1, std::memory_order_relaxed) << shard_bits) | shard_idx);
+
+	Shard &shard = shards_[shard_idx];
+	std::lock_guard<std::mutex> locked(shard.mutex);
+	if (!shard.by_grounding.insert(a).second)
+		throw DuplicateTransition("Activity is already running: " + a->str());
+	shard.by_id.emplace(a->activity_id(), a);
+}
+
+
+shared_ptr<Activity> ActivityTable::find(const shared_ptr<Transition> &t, std::unique_lock<std::mutex> &lock)
+{
+	if (t->activity_id()) {
+		Shard &shard = shards_[t->activity_id() & (num_shards - 1)];
+		lock = std::unique_lock<std::mutex>(shard.mutex);
+		auto it = shard.by_id.find(t->activity_id());
+		return it == shard.by_id.end() ? nullptr : it->second;
+	}
+
+	Shard &shard = shards_[t->hash() & (num_shards - 1)];
+	lock = std::unique_lock<std::mutex>(shard.mutex);
+	auto it = shard.by_grounding.find(t);
+	return it == shard.by_grounding.end() ? nullptr : std::dynamic_pointer_cast<Activity>(*it);
+}
+
+
+void ActivityTable::erase(const shared_ptr<Activity> &a, std::unique_lock<std::mutex> &)
+{
+	Shard &shard = shards_[a->activity_id() & (num_shards - 1)];
+	shard.by_id.erase(a->activity_id());
+	shard.by_grounding.erase(a);
+}
+
+
+
+PlatformBackend::PlatformBackend(size_t worker_threads)
+: worker_threads_(worker_threads)
+{}
+
+PlatformBackend::~PlatformBackend()
+{ shutdown_executor(); }
+
 void PlatformBackend::start_activity(shared_ptr<Transition> trans)
 {
-	std::lock_guard<std::mutex> locked(mutex_);
-	shared_ptr<Activity> a = std::make_shared<Activity>(trans);
-	execute_activity(a);
+	shared_ptr<Activity> a = make_pooled<Activity>(trans);
 	activities_.insert(a);
+	trans->set_activity_id(a->activity_id());
+	try {
+		execute_activity(a);
+	} catch (...) {
+		std::unique_lock<std::mutex> lock;
+		if (activities_.find(trans, lock))
+			activities_.erase(a, lock);
+		throw;
+	}
 }
 
 
 shared_ptr<Activity> PlatformBackend::end_activity(shared_ptr<Transition> trans)
 {
-	std::lock_guard<std::mutex> locked(mutex_);
-
-	ActivitySet::iterator it = activities_.find(trans);
-	shared_ptr<Activity> dur_running;
-	if (it != activities_.end())
-		dur_running = std::dynamic_pointer_cast<Activity>(*it);
+	std::unique_lock<std::mutex> lock;
+	shared_ptr<Activity> dur_running = activities_.find(trans, lock);
 
 	if (!dur_running)
 		throw LostTransition(trans->str());
@@ -56,20 +119,19 @@ shared_ptr<Activity> PlatformBackend::end_activity(shared_ptr<Transition> trans)
 	if (dur_running->state() != trans2state(trans->hook()))
 			throw InconsistentTransition(trans->str());
 
-	activities_.erase(it);
+	activities_.erase(dur_running, lock);
 
 	return dur_running;
 }
 
 
-void PlatformBackend::update_activity(shared_ptr<Transition> trans, Value *sensing_result)
+void PlatformBackend::update_activity(shared_ptr<Transition> trans, SensingResult &&sensing_result)
 {
-	std::lock_guard<std::mutex> locked(mutex_);
+	// Usually called from a thread of the backend
+	AExecutionContext::ThreadBinding binding(*exec_ctx_);
 
-	ActivitySet::iterator it = activities_.find(trans);
-	shared_ptr<Activity> a;
-	if (it != activities_.end())
-		a = std::dynamic_pointer_cast<Activity>(*it);
+	std::unique_lock<std::mutex> lock;
+	shared_ptr<Activity> a = activities_.find(trans, lock);
 
 	if (!a)
 		throw LostTransition(trans->str());
@@ -85,72 +147,132 @@ void PlatformBackend::update_activity(shared_ptr<Transition> trans, Value *sensi
 				+ static_cast<const Grounding<Action> &>(*a).str()
 				+ ", but it is not a sensing action"
 			);
+		else if (sensing_result.is_numeric_array()) {
+			const Type &sensed_type = a->target()->senses()->type();
+			if (!sensed_type.is<ListType>()
+				|| !dynamic_cast<const ListType &>(sensed_type).element_type().is<NumberType>()
+			)
+				throw Bug("PlatformBackend implementation gave a numeric array as sensing result to "
+					+ static_cast<const Grounding<Action> &>(*a).str()
+					+ ", but it senses a " + sensed_type.name()
+				);
+			a->set_sensing_result(std::move(sensing_result));
+		}
 		else if (sensing_result) {
-			sensing_result->attach_semantics(exec_ctx_->semantics_factory());
-			a->set_sensing_result(sensing_result);
+			sensing_result.value()->attach_semantics(exec_ctx_->semantics_factory());
+			a->set_sensing_result(std::move(sensing_result));
 		}
 	}
 
 	a->set_state(trans2state(trans->hook()));
+	lock.unlock();
 
 	exec_ctx_->exog_queue_push(a);
 }
 
 
-void PlatformBackend::set_context(AExecutionContext *ctx)
-{ exec_ctx_ = ctx; }
+void PlatformBackend::preempt_activity(shared_ptr<Transition> t)
+{
+	ActivityId id = t->activity_id();
+	if (!id) {
+		std::unique_lock<std::mutex> lock;
+		if (shared_ptr<Activity> a = activities_.find(t, lock))
+			id = a->activity_id();
+	}
 
+	std::lock_guard<std::mutex> locked(executor_mutex_);
+	auto it = tokens_.find(id);
+	if (it == tokens_.end())
+		throw EngineError("No such activity: " + t->str());
+	it->second->cancel();
+}
 
 
-DummyBackend::DummyBackend()
-: uniform_dist_(0.1, 2.0)
-, prng_(1)
-{}
+void PlatformBackend::run_activity(shared_ptr<Activity> a, ActivityTask &&task)
+{
+	shared_ptr<CancellationToken> token = std::make_shared<CancellationToken>();
+
+	std::lock_guard<std::mutex> locked(executor_mutex_);
+	if (!executor_)
+		executor_.reset(new ActivityExecutor(worker_threads_));
+	tokens_[a->activity_id()] = token;
+
+	executor_->submit([this, a, token, task = std::move(task)] () {
+		AExecutionContext::ThreadBinding binding(*exec_ctx_);
+		ActivityResult result = ActivityResult::stop();
+		if (!token->cancelled()) {
+			try {
+				result = task(*a, *token);
+			} catch (std::exception &e) {
+				log(LogLevel::ERR, [&] (std::ostream &s) { s << "Activity " << a->str() << " FAILED: " << e.what(); });
+				result = ActivityResult::fail();
+			}
+		}
 
+		{
+			std::lock_guard<std::mutex> locked(executor_mutex_);
+			tokens_.erase(a->activity_id());
+		}
 
-void DummyBackend::ActivityThread::end_activity(std::chrono::duration<double> when, DummyBackend &b, shared_ptr<Activity> a)
-{
-	std::unique_lock<std::mutex> cancel_lock(cancel_mutex);
-	bool canceled = cancel_cond.wait_for(cancel_lock, when, [&] { return bool(cancel); });
+		std::lock_guard<std::mutex> reporting(report_mutex_);
+		if (reporting_)
+			update_activity(a->transition(result.hook), std::move(result.sensing_result));
+	} );
+}
 
-	if (canceled) {
-		std::cout << "DummyBackend: Activity " << a->str() << " STOPPED" << std::endl;
-		b.update_activity(a->transition(Transition::Hook::STOP));
-	}
-	else {
-		std::cout << "DummyBackend: Activity " << a->str() << " FINAL" << std::endl;
-		b.update_activity(a->transition(Transition::Hook::FINISH));
+
+void PlatformBackend::shutdown_executor()
+{
+	{
+		std::lock_guard<std::mutex> reporting(report_mutex_);
+		reporting_ = false;
 	}
 
-	std::lock_guard<std::mutex> locked(b.thread_mtx_);
-	thread->detach();
-	b.activity_threads_.erase(a);
+	unique_ptr<ActivityExecutor> executor;
+	{
+		std::lock_guard<std::mutex> locked(executor_mutex_);
+		for (auto &entry : tokens_)
+			entry.second->cancel();
+		executor.reset(executor_.release());
+	}
+	// Joins the workers outside of executor_mutex_, which they need to finish
+	executor.reset();
 }
 
 
-void DummyBackend::execute_activity(shared_ptr<Activity> a)
-{
-	std::chrono::duration<double> rnd_dur { uniform_dist_(prng_) };
-	std::cout << "DummyBackend: Activity " << a->str() << " START, duration: " << rnd_dur.count() << std::endl;
+void PlatformBackend::set_context(AExecutionContext *ctx)
+{ exec_ctx_ = ctx; }
+
+void PlatformBackend::before_step(uint64_t)
+{}
 
-	std::lock_guard<std::mutex> locked(thread_mtx_);
 
-	shared_ptr<ActivityThread> at = std::make_shared<ActivityThread>();
-	at->thread = std::make_unique<std::thread>( [at, rnd_dur, this, a] () {
-		at->end_activity(rnd_dur, *this, a);
-	});
 
-	activity_threads_[a] = at;
-}
+DummyBackend::DummyBackend()
+: uniform_dist_(0.1, 2.0)
+, prng_(1)
+{}
+
+
+DummyBackend::~DummyBackend()
+{ shutdown_executor(); }
 
 
-void DummyBackend::preempt_activity(shared_ptr<Transition> t)
+void DummyBackend::execute_activity(shared_ptr<Activity> a)
 {
-	std::lock_guard<std::mutex> locked(thread_mtx_);
-	if (activity_threads_.find(t) == activity_threads_.end())
-		throw EngineError("No such activity: " + t->str());
-	activity_threads_[t]->cancel = true;
-	activity_threads_[t]->cancel_cond.notify_all();
+	std::chrono::duration<double> rnd_dur { uniform_dist_(prng_) };
+	log(LogLevel::INF, [&] (std::ostream &s) {
+		s << "DummyBackend: Activity " << a->str() << " START, duration: " << rnd_dur.count();
+	} );
+
+	run_activity(a, [rnd_dur] (Activity &a, CancellationToken &token) {
+		if (token.wait_for(rnd_dur)) {
+			log(LogLevel::INF, [&] (std::ostream &s) { s << "DummyBackend: Activity " << a.str() << " STOPPED"; });
+			return ActivityResult::stop();
+		}
+		log(LogLevel::INF, [&] (std::ostream &s) { s << "DummyBackend: Activity " << a.str() << " FINAL"; });
+		return ActivityResult::finish();
+	} );
 }
 
 
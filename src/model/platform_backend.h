@@ -4,7 +4,10 @@
 #include "gologpp.h"
 #include "action.h"
 #include "reference.h"
+#include "transition.h"
+#include "activity_executor.h"
 
+#include <array>
 #include <random>
 #include <chrono>
 #include <unordered_set>
@@ -24,38 +27,142 @@ struct Clock {
 	using time_point = std::chrono::time_point<Clock, Clock::duration>;
 	static constexpr bool is_steady = true;
 
+	/// Process-wide default: The backend of the most recently created execution context.
 	static PlatformBackend *clock_source;
 
+	/// Overrides @ref clock_source on the current thread, e.g. while an execution context runs on it.
+	static thread_local PlatformBackend *thread_clock_source;
+
 	static time_point now() noexcept;
 };
 
 
 
-class PlatformBackend {
+/**
+ * @brief What an action implementation run by @ref PlatformBackend::run_activity reports when it returns.
+ */
+struct ActivityResult {
+	/// @param sensing_result Must be given for sensing actions.
+	static ActivityResult finish(SensingResult &&sensing_result = SensingResult());
+	static ActivityResult fail();
+	static ActivityResult stop();
+
+	Transition::Hook hook;
+	SensingResult sensing_result;
+};
+
+
+
+/**
+ * @brief The running activities of a @ref PlatformBackend, split into independently locked shards
+ * by the hash of their grounding.
+ * Each activity gets an id that also encodes its shard, so a transition that carries the id is
+ * found with integer operations only. Transitions from the history carry no id and are looked up
+ * by their grounding.
+ */
+class ActivityTable {
 public:
 	using ActivitySet = std::unordered_set<
 		shared_ptr<Grounding<Action>>,
 		Grounding<Action>::Hash,
 		Grounding<Action>::Equals
 	>;
+
+	static constexpr unsigned int shard_bits = 4;
+	static constexpr size_t num_shards = size_t(1) << shard_bits;
+
+	ActivityTable();
+
+	/// Assign a new id to @param a and insert it.
+	/// @throw DuplicateTransition if an activity with the same grounding is already running.
+	void insert(const shared_ptr<Activity> &a);
+
+	/// @return The activity that @param t belongs to, or nullptr. Its shard stays locked by @param lock.
+	shared_ptr<Activity> find(const shared_ptr<Transition> &t, std::unique_lock<std::mutex> &lock);
+
+	/// Remove @param a, which must have been returned by @ref find while @param lock is still held.
+	void erase(const shared_ptr<Activity> &a, std::unique_lock<std::mutex> &lock);
+
+private:
+	struct Shard {
+		std::mutex mutex;
+		std::unordered_map<ActivityId, shared_ptr<Activity>> by_id;
+		ActivitySet by_grounding;
+	};
+
+	std::array<Shard, num_shards> shards_;
+	std::atomic<ActivityId> next_id_;
+};
+
+
+
+class PlatformBackend {
+public:
+	using ActivitySet = ActivityTable::ActivitySet;
+
+	/// The code that implements an action. It runs on a worker thread of the backend.
+	using ActivityTask = std::function<ActivityResult (Activity &, CancellationToken &)>;
+
+	/// @param worker_threads Size of the worker pool used by @ref run_activity. It's only started on first use.
+	PlatformBackend(size_t worker_threads = ActivityExecutor::default_workers());
 	virtual ~PlatformBackend();
 
 	shared_ptr<Activity> end_activity(shared_ptr<Transition>);
 	void start_activity(shared_ptr<Transition>);
-	virtual void preempt_activity(shared_ptr<Transition>) = 0;
 
-	void update_activity(shared_ptr<Transition>, Value *sensing_result = nullptr);
+	/**
+	 * @brief Preempt a running activity. The default implementation cancels the token of an
+	 * activity that was started with @ref run_activity and throws an @ref EngineError for any other.
+	 */
+	virtual void preempt_activity(shared_ptr<Transition>);
+
+	/**
+	 * @brief Report a state change of a running activity.
+	 * @param sensing_result Must be given when a sensing action finishes. It is moved into the
+	 * @ref Activity, so a numeric array reaches the history without being copied.
+	 */
+	void update_activity(shared_ptr<Transition>, SensingResult &&sensing_result = SensingResult());
 
 	virtual Clock::time_point time() const noexcept = 0;
 	void set_context(AExecutionContext *ctx);
 
+	/**
+	 * @brief Called by the @ref ExecutionContext at the start of each iteration of its main loop,
+	 * before pending exogenous events are processed.
+	 * @param step Number of transitions so far.
+	 */
+	virtual void before_step(uint64_t step);
+
+
+protected:
+	/**
+	 * @brief Run @param task for the activity @param a on the worker pool.
+	 * The activity is updated with the @ref ActivityResult that the task returns, or FAILED if it
+	 * throws. An activity that is preempted before a worker picks it up is STOPPED without running
+	 * the task. Meant to be called from @ref execute_activity.
+	 */
+	void run_activity(shared_ptr<Activity> a, ActivityTask &&task);
+
+	/**
+	 * @brief Cancel all activities started with @ref run_activity and join the worker pool.
+	 * Activities that end after this call are not reported anymore. Backends whose tasks refer
+	 * to their own members must call this in their destructor.
+	 */
+	void shutdown_executor();
+
 
 private:
 	virtual void execute_activity(shared_ptr<Activity> a) = 0;
 
-	ActivitySet activities_;
+	ActivityTable activities_;
 	AExecutionContext *exec_ctx_ = nullptr;
-	std::mutex mutex_;
+
+	const size_t worker_threads_;
+	std::mutex executor_mutex_;
+	unique_ptr<ActivityExecutor> executor_;
+	std::unordered_map<ActivityId, shared_ptr<CancellationToken>> tokens_;
+	std::mutex report_mutex_;
+	bool reporting_ = true;
 };
 
 
@@ -63,8 +170,8 @@ private:
 class DummyBackend : public PlatformBackend {
 public:
 	DummyBackend();
+	virtual ~DummyBackend() override;
 
-	virtual void preempt_activity(shared_ptr<Transition>) override;
 	virtual Clock::time_point time() const noexcept override;
 
 private:
@@ -72,26 +179,10 @@ private:
 
 	std::uniform_real_distribution<> uniform_dist_;
 	std::mt19937 prng_;
-	std::mutex thread_mtx_;
-
-	struct ActivityThread {
-	public:
-		std::unique_ptr<std::thread> thread;
-		std::condition_variable cancel_cond;
-		std::mutex cancel_mutex;
-		std::atomic_bool cancel;
-		void end_activity(std::chrono::duration<double> when, DummyBackend &b, shared_ptr<Activity> a);
-	};
-
-	std::unordered_map<
-		shared_ptr<Grounding<Action>>, shared_ptr<ActivityThread>,
-		Grounding<Action>::Hash, Grounding<Action>::Equals
-	> activity_threads_;
 };
 
 
 
-
 } // namespace gologpp
 
 #endif // GOLOGPP_PLATFORM_BACKEND_H_
@@ -107,6 +107,23 @@ const Expression &Conditional::block_true() const
 { return *block_true_; }
 
 
+Expression *Conditional::simplify(Simplification &s)
+{
+	s.simplify_member(condition_, *this);
+	s.simplify_member(block_true_, *this);
+	s.simplify_member(block_false_, *this);
+
+	bool cond;
+	if (!get_bool(*condition_, cond))
+		return this;
+
+	// The condition is constant, so only one branch is alive
+	SafeExprOwner<VoidType> &alive = cond ? block_true_ : block_false_;
+	s.record(*this, *alive);
+	return alive.release();
+}
+
+
 string Conditional::to_string(const string &pfx) const
 {
 	return linesep + pfx + "if (" + condition().to_string("") + ") " + block_true().to_string(pfx)
@@ -341,6 +358,9 @@ void Function::define(Expression *definition)
 	definition_->set_parent(this);
 }
 
+void Function::simplify(Simplification &s)
+{ s.simplify_member(definition_, *this); }
+
 
 string Function::to_string(const string &pfx) const
 {
@@ -370,6 +390,12 @@ DurativeCall::Hook DurativeCall::hook() const
 const Reference<Action> &DurativeCall::action() const
 { return *action_; }
 
+Expression *DurativeCall::simplify(Simplification &s)
+{
+	action_->simplify(s);
+	return this;
+}
+
 string DurativeCall::to_string(const string &pfx) const
 { return linesep + pfx + gologpp::to_string(hook()) + "(" + action().str() + ");"; }
 
@@ -19,6 +19,7 @@
 #include "action.h"
 #include "reference.h"
 #include "fluent.h"
+#include "simplification.h"
 
 namespace gologpp {
 
@@ -30,6 +31,7 @@ class Block : public Expression, public ScopeOwner, public LanguageElement<Block
 public:
 	Block(Scope *own_scope, const vector<Expression *> &elements);
 	virtual void attach_semantics(SemanticsFactory &) override;
+	DEFINE_SIMPLIFY_WITH_MEMBERS(elements_)
 
 	const vector<SafeExprOwner<VoidType>> &elements() const;
 
@@ -48,6 +50,7 @@ class Choose : public Expression, public ScopeOwner, public LanguageElement<Choo
 public:
 	Choose(Scope *own_scope, const vector<Expression *> &alternatives);
 	void attach_semantics(SemanticsFactory &) override;
+	DEFINE_SIMPLIFY_WITH_MEMBERS(alternatives_)
 
 	const vector<SafeExprOwner<VoidType>> &alternatives() const;
 
@@ -72,6 +75,8 @@ public:
 
 	DEFINE_ATTACH_SEMANTICS_WITH_MEMBERS(*condition_, *block_true_, *block_false_)
 
+	virtual Expression *simplify(Simplification &) override;
+
 	const Expression &condition() const;
 	const Expression &block_true() const;
 	const Expression &block_false() const;
@@ -93,6 +98,7 @@ class Concurrent : public Expression, public ScopeOwner, public LanguageElement<
 public:
 	Concurrent(Scope *own_scope, const vector<Expression *> &procs);
 	void attach_semantics(SemanticsFactory &) override;
+	DEFINE_SIMPLIFY_WITH_MEMBERS(procs_)
 
 	const vector<SafeExprOwner<VoidType>> &procs() const;
 
@@ -142,6 +148,7 @@ public:
 	}
 
 	DEFINE_ATTACH_SEMANTICS_WITH_MEMBERS(*lhs_, *rhs_)
+	DEFINE_SIMPLIFY_WITH_MEMBERS(lhs_, rhs_)
 
 	const LhsT &lhs() const override
 	{ return *lhs_; }
@@ -178,6 +185,7 @@ public:
 	const Expression &statement() const;
 
 	virtual void attach_semantics(SemanticsFactory &f) override;
+	DEFINE_SIMPLIFY_WITH_MEMBERS(statement_)
 
 	virtual string to_string(const string &pfx) const override;
 
@@ -199,6 +207,7 @@ class Search : public Expression, public NoScopeOwner, public LanguageElement<Se
 public:
 	Search(Expression *statement);
 	DEFINE_ATTACH_SEMANTICS_WITH_MEMBERS(*statement_)
+	DEFINE_SIMPLIFY_WITH_MEMBERS(statement_)
 
 	const Expression &statement() const;
 
@@ -228,6 +237,7 @@ public:
 	const Expression &horizon() const;
 	const Reference<Function> &reward() const;
 	virtual void attach_semantics(SemanticsFactory &implementor) override;
+	DEFINE_SIMPLIFY_WITH_MEMBERS(statement_, horizon_, reward_)
 	virtual string to_string(const string &pfx) const override;
 
 private:
@@ -245,6 +255,7 @@ class Test : public Expression, public NoScopeOwner, public LanguageElement<Test
 public:
 	Test(Expression *expression);
 	DEFINE_ATTACH_SEMANTICS_WITH_MEMBERS(*expression_)
+	DEFINE_SIMPLIFY_WITH_MEMBERS(expression_)
 
 	const Expression &expression() const;
 
@@ -263,6 +274,7 @@ class While : public Expression, public NoScopeOwner, public LanguageElement<Whi
 public:
 	While(Expression *expression, Expression *stmt);
 	DEFINE_ATTACH_SEMANTICS_WITH_MEMBERS(*expression_, *statement_)
+	DEFINE_SIMPLIFY_WITH_MEMBERS(expression_, statement_)
 
 	const Expression &expression() const;
 	const Expression &statement() const;
@@ -283,6 +295,7 @@ class Return : public Expression, public NoScopeOwner, public LanguageElement<Re
 public:
 	Return(Expression *expr);
 	DEFINE_ATTACH_SEMANTICS_WITH_MEMBERS(*expr_)
+	DEFINE_SIMPLIFY_WITH_MEMBERS(expr_)
 
 	const Expression &expression() const;
 	virtual string to_string(const string &pfx) const override;
@@ -328,6 +341,8 @@ public:
 
 	DEFINE_ATTACH_SEMANTICS_WITH_MEMBERS(scope(), *definition_)
 
+	virtual void simplify(Simplification &) override;
+
 private:
 	SafeExprOwner<VoidType> definition_;
 	vector<shared_ptr<Variable>> params_;
@@ -348,6 +363,8 @@ public:
 	DurativeCall(Hook hook, Reference<Action> *action);
 	DEFINE_ATTACH_SEMANTICS_WITH_MEMBERS(*action_)
 
+	virtual Expression *simplify(Simplification &) override;
+
 	Hook hook() const;
 	const Reference<Action> &action() const;
 	virtual string to_string(const string &pfx) const override;
@@ -373,6 +390,7 @@ public:
 	const string &field_name() const;
 
 	DEFINE_ATTACH_SEMANTICS_WITH_MEMBERS(*subject_)
+	DEFINE_SIMPLIFY_WITH_MEMBERS(subject_)
 
 	virtual const Type &type() const override;
 
@@ -396,6 +414,7 @@ public:
 	const Expression &index() const;
 
 	DEFINE_ATTACH_SEMANTICS_WITH_MEMBERS(*subject_, *index_)
+	DEFINE_SIMPLIFY_WITH_MEMBERS(subject_, index_)
 
 	virtual const Type &type() const override;
 
@@ -418,6 +437,7 @@ public:
 	const Expression &subject() const;
 
 	DEFINE_ATTACH_SEMANTICS_WITH_MEMBERS(*subject_)
+	DEFINE_SIMPLIFY_WITH_MEMBERS(subject_)
 
 	string to_string(const string &pfx) const override;
 
@@ -444,6 +464,7 @@ public:
 	ListOpEnd which_end() const;
 
 	DEFINE_ATTACH_SEMANTICS_WITH_MEMBERS(*list_)
+	DEFINE_SIMPLIFY_WITH_MEMBERS(list_)
 
 	string to_string(const string &pfx) const override;
 
@@ -466,6 +487,7 @@ public:
 	const Expression &what() const;
 
 	DEFINE_ATTACH_SEMANTICS_WITH_MEMBERS(*list_, *what_)
+	DEFINE_SIMPLIFY_WITH_MEMBERS(list_, what_)
 
 	string to_string(const string &pfx) const override;
 
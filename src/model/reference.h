@@ -9,6 +9,7 @@
 #include "error.h"
 #include "variable.h"
 #include "domain.h"
+#include "simplification.h"
 
 #include <memory>
 #include <vector>
@@ -40,18 +41,21 @@ class ReferenceBase
 , public NoScopeOwner
 {
 public:
+	/// Groundings only exist at runtime, so they can own their target. References in code must not,
+	/// since a global may refer to itself.
+	using TargetPtr = typename std::conditional<
+		std::is_same<ArgsT, Value>::value,
+		shared_ptr<TargetT>,
+		weak_ptr<TargetT>
+	>::type;
+
 	ReferenceBase(const shared_ptr<TargetT> &target, vector<unique_ptr<ArgsT>> &&args)
 	: args_(std::move(args))
 	, target_(target)
+	, raw_target_(target.get())
 	{
-		size_t idx = 0;
-		while (idx < this->args().size() && idx < this->target()->params().size()) {
-			ArgsT &arg = *this->args()[idx];
-			shared_ptr<Variable> param = this->target()->params()[idx];
-			params_to_args_.insert( { param, arg } );
-			dynamic_cast<Expression &>(arg).set_parent(this);
-			++idx;
-		}
+		for (unique_ptr<ArgsT> &arg : args_)
+			arg->set_parent(this);
 		ensure_consistent();
 	}
 
@@ -75,22 +79,26 @@ public:
 	ReferenceBase(ReferenceBase<TargetT, ArgsT> &&other)
 	: args_(std::move(other.args_))
 	, target_(std::move(other.target_))
-	{ ensure_consistent(); }
+	, raw_target_(other.raw_target_)
+	{
+		for (unique_ptr<ArgsT> &arg : args_)
+			arg->set_parent(this);
+	}
 
 
 	virtual ~ReferenceBase() override = default;
 
 	TargetT &operator * () const
-	{ return target(); }
+	{ return *raw_target_; }
 
 	TargetT *operator -> () const
-	{ return &target(); }
+	{ return raw_target_; }
 
 	bool operator == (const ReferenceBase<TargetT, ArgsT> &other) const
 	{
-		if (this->target() != other.target())
+		if (raw_target_ != other.raw_target_)
 			return false;
-		for (arity_t i = 0; i < this->target()->arity(); ++i) {
+		for (arity_t i = 0; i < raw_target_->arity(); ++i) {
 			if (*this->args()[i] != *other.args()[i])
 				return false;
 		}
@@ -101,13 +109,13 @@ public:
 	{ return !(*this == other); }
 
 	const string &name() const
-	{ return target_.lock()->name(); }
+	{ return raw_target_->name(); }
 
 	arity_t arity() const
-	{ return target_.lock()->arity(); }
+	{ return raw_target_->arity(); }
 
 	virtual bool bound() const override
-	{ return !target_.expired(); }
+	{ return raw_target_ && !expired(target_); }
 
 	const vector<unique_ptr<ArgsT>> &args() const
 	{ return args_; }
@@ -118,33 +126,38 @@ public:
 
 	const ArgsT &arg_for_param(shared_ptr<const Variable> param) const
 	{
-		auto it = params_to_args_.find(param);
-		if (it == params_to_args_.end())
-			throw Bug(target()->str() + " has no parameter by the name " + param->str());
+		arity_t idx = raw_target_->param_index(*param);
+		if (idx >= args().size())
+			throw Bug(raw_target_->str() + " has no parameter by the name " + param->str());
 
-		return it->second;
+		return *args()[idx];
 	}
 
 
 	virtual bool consistent() const override
 	{
-		if (!bound() || args().size() != target()->params().size())
+		if (!bound() || args().size() != raw_target_->params().size())
 			return false;
 
 		// Compare target argument types with this reference's argument types
 		auto it_rarg = args().begin();
-		auto it_targ = target()->params().begin();
-		for (; it_rarg < args().end() && it_targ < target()->params().end(); ++it_rarg, ++it_targ) {
+		auto it_targ = raw_target_->params().begin();
+		for (; it_rarg < args().end() && it_targ < raw_target_->params().end(); ++it_rarg, ++it_targ) {
 			const Type &t_ref = (*it_rarg)->type();
 			const Type &t_tgt = (*it_targ)->type();
-			if (t_ref != t_tgt
+			if (&t_ref != &t_tgt
+				&& t_ref != t_tgt
 				&& !(t_ref.is<SymbolType>() && t_tgt.is<StringType>())
 				// TODO: Hack: Allow passing a symbol value to a string argument
 				// This is needed because ReadyLog can't deal with strings.
 			)
 				return false;
 
-			if ((*it_rarg)->is_ref() && !dynamic_cast<AbstractReference &>(**it_rarg).consistent())
+			if (
+				!std::is_same<ArgsT, Value>::value
+				&& (*it_rarg)->is_ref()
+				&& !dynamic_cast<AbstractReference &>(**it_rarg).consistent()
+			)
 				return false;
 		}
 
@@ -153,10 +166,10 @@ public:
 
 
 	shared_ptr<TargetT> target()
-	{ return target_.lock(); }
+	{ return lock(target_); }
 
 	shared_ptr<const TargetT> target() const
-	{ return std::dynamic_pointer_cast<const TargetT>(target_.lock()); }
+	{ return lock(target_); }
 
 
 	virtual void attach_semantics(SemanticsFactory &f) override
@@ -165,15 +178,22 @@ public:
 			expr->attach_semantics(f);
 	}
 
+	virtual Expression *simplify(Simplification &s) override
+	{
+		for (unique_ptr<ArgsT> &arg : args_)
+			s.simplify_member(arg, *this);
+		return this;
+	}
+
 	virtual string to_string(const string &pfx) const override
 	{ return pfx + name() + '(' + concat_list(args(), ", ", "") + ')'; }
 
 	virtual const Type &type() const override
-	{ return this->target()->type(); }
+	{ return raw_target_->type(); }
 
 	size_t hash() const
 	{
-		size_t rv = this->target()->hash();
+		size_t rv = raw_target_->hash();
 		for (const unique_ptr<ArgsT> &c : this->args())
 			boost::hash_combine(rv, c->hash());
 
@@ -182,13 +202,22 @@ public:
 
 
 private:
-	vector<unique_ptr<ArgsT>> args_;
-	weak_ptr<TargetT> target_;
+	static bool expired(const shared_ptr<TargetT> &p)
+	{ return !p; }
+
+	static bool expired(const weak_ptr<TargetT> &p)
+	{ return p.expired(); }
 
-	std::unordered_map<
-		shared_ptr<const Variable>,
-		std::reference_wrapper<ArgsT>
-	> params_to_args_;
+	static shared_ptr<TargetT> lock(const shared_ptr<TargetT> &p)
+	{ return p; }
+
+	static shared_ptr<TargetT> lock(const weak_ptr<TargetT> &p)
+	{ return p.lock(); }
+
+	vector<unique_ptr<ArgsT>> args_;
+	TargetPtr target_;
+	// Stays valid as long as the target is bound. Saves locking the weak_ptr in references.
+	TargetT *raw_target_;
 };
 
 
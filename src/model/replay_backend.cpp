@@ -0,0 +1,192 @@
+#include "replay_backend.h"
+#include "logger.h"
+
+#include <algorithm>
+
+namespace gologpp {
+
+
+static Transition::Hook state2trans(Activity::State state)
+{
+	switch (state) {
+	case Activity::State::FINAL:
+		return Transition::Hook::FINISH;
+	case Activity::State::PREEMPTED:
+		return Transition::Hook::STOP;
+	case Activity::State::FAILED:
+		return Transition::Hook::FAIL;
+	case Activity::State::IDLE:
+	case Activity::State::RUNNING:
+		break;
+	}
+	throw Bug("Activity state " + to_string(state) + " is not an outcome");
+}
+
+
+string ReplayBackend::key(const string &action, const vector<unique_ptr<Value>> &args)
+{
+	string rv = action + "(";
+	for (const unique_ptr<Value> &arg : args)
+		rv += arg->str() + ",";
+	return rv + ")";
+}
+
+
+ReplayBackend::ReplayBackend(const string &trace_file, bool original_timing)
+: original_timing_(original_timing)
+, num_outcomes_(0)
+, running_(true)
+{
+	TraceReader reader(trace_file);
+	start_time_ = Clock::time_point(std::chrono::duration_cast<Clock::duration>(
+		reader.start_time().time_since_epoch()
+	));
+	last_time_ = start_time_.time_since_epoch().count();
+
+	// Start times of the activities that are running at the current point of the trace
+	std::unordered_map<string, std::deque<std::chrono::nanoseconds>> started;
+
+	TraceRecord r;
+	while (reader.next(r)) {
+		if (r.kind == TraceRecordKind::TRANSITION && r.hook == Transition::Hook::START)
+			started[key(r.action, r.args)].push_back(r.time);
+		else if (r.kind == TraceRecordKind::ACTIVITY
+			&& r.state != Activity::State::IDLE && r.state != Activity::State::RUNNING
+		) {
+			string k = key(r.action, r.args);
+			std::chrono::nanoseconds duration(0);
+			std::deque<std::chrono::nanoseconds> &starts = started[k];
+			if (!starts.empty()) {
+				duration = r.time - starts.front();
+				starts.pop_front();
+			}
+			outcomes_[k].push_back(Outcome {
+				r.step, r.time, duration, r.state, std::move(r.sensing_result)
+			});
+			++num_outcomes_;
+		}
+	}
+
+	if (original_timing_)
+		timer_thread_ = std::thread(&ReplayBackend::run_timed, this);
+}
+
+
+ReplayBackend::~ReplayBackend()
+{
+	if (timer_thread_.joinable()) {
+		{
+			std::lock_guard<std::mutex> locked(scheduled_mutex_);
+			running_ = false;
+		}
+		scheduled_cond_.notify_all();
+		timer_thread_.join();
+	}
+}
+
+
+void ReplayBackend::execute_activity(shared_ptr<Activity> a)
+{
+	std::lock_guard<std::mutex> locked(scheduled_mutex_);
+
+	auto it = outcomes_.find(key(a->target()->name(), a->args()));
+	if (it == outcomes_.end() || it->second.empty()) {
+		log(LogLevel::WRN, [&] (std::ostream &s) {
+			s << "ReplayBackend: No recorded outcome for " << a->str() << ", leaving it running";
+		} );
+		return;
+	}
+
+	Outcome &o = it->second.front();
+	std::chrono::steady_clock::time_point due = std::chrono::steady_clock::now() + o.duration;
+	scheduled_.push_back(Scheduled { a, std::move(o), due });
+	it->second.pop_front();
+	--num_outcomes_;
+
+	if (original_timing_)
+		scheduled_cond_.notify_all();
+}
+
+
+void ReplayBackend::deliver(Scheduled &s)
+{
+	last_time_ = (start_time_ + std::chrono::duration_cast<Clock::duration>(s.outcome.time))
+		.time_since_epoch().count();
+	update_activity(s.activity->transition(state2trans(s.outcome.state)), std::move(s.outcome.sensing_result));
+}
+
+
+void ReplayBackend::before_step(uint64_t step)
+{
+	if (original_timing_)
+		return;
+
+	vector<Scheduled> due;
+	{
+		std::lock_guard<std::mutex> locked(scheduled_mutex_);
+		for (auto it = scheduled_.begin(); it != scheduled_.end();) {
+			if (it->outcome.step <= step) {
+				due.push_back(std::move(*it));
+				it = scheduled_.erase(it);
+			}
+			else
+				++it;
+		}
+	}
+
+	std::sort(due.begin(), due.end(), [] (const Scheduled &lhs, const Scheduled &rhs) {
+		return lhs.outcome.time < rhs.outcome.time;
+	} );
+
+	for (Scheduled &s : due)
+		deliver(s);
+}
+
+
+void ReplayBackend::run_timed()
+{
+	std::unique_lock<std::mutex> locked(scheduled_mutex_);
+	while (running_) {
+		if (scheduled_.empty()) {
+			scheduled_cond_.wait(locked);
+			continue;
+		}
+
+		auto next = std::min_element(scheduled_.begin(), scheduled_.end(),
+			[] (const Scheduled &lhs, const Scheduled &rhs) { return lhs.due < rhs.due; }
+		);
+		if (std::chrono::steady_clock::now() < next->due) {
+			scheduled_cond_.wait_until(locked, next->due);
+			continue;
+		}
+
+		Scheduled s = std::move(*next);
+		scheduled_.erase(next);
+		locked.unlock();
+		deliver(s);
+		locked.lock();
+	}
+}
+
+
+void ReplayBackend::preempt_activity(shared_ptr<Transition>)
+{}
+
+
+Clock::time_point ReplayBackend::time() const noexcept
+{
+	if (original_timing_)
+		return Clock::time_point(std::chrono::steady_clock::now().time_since_epoch());
+	else
+		return Clock::time_point(Clock::duration(last_time_.load()));
+}
+
+
+size_t ReplayBackend::pending() const
+{
+	std::lock_guard<std::mutex> locked(scheduled_mutex_);
+	return num_outcomes_ + scheduled_.size();
+}
+
+
+} // namespace gologpp
@@ -0,0 +1,79 @@
+#ifndef GOLOGPP_REPLAY_BACKEND_H_
+#define GOLOGPP_REPLAY_BACKEND_H_
+
+#include "platform_backend.h"
+#include "trace.h"
+
+#include <deque>
+#include <list>
+#include <unordered_map>
+
+namespace gologpp {
+
+
+/**
+ * @brief A @ref PlatformBackend that reproduces the activity outcomes from a trace written by
+ * a @ref TraceRecorder: Every started activity ends the way the N-th activity with the same
+ * action and arguments ended in the trace, with the same sensing result.
+ *
+ * With the original timing, an activity ends after its recorded duration. Without it, the outcome
+ * is delivered from @ref before_step when the execution context reaches the number of transitions
+ * at which the outcome was originally processed. That involves no threads and no clock, so a
+ * fixed program takes exactly the recorded transitions. In that mode, @ref time is the time of the
+ * last delivered outcome.
+ *
+ * Activities that never ended in the trace keep running. @ref preempt_activity does nothing,
+ * since a recorded preemption is replayed like any other outcome.
+ */
+class ReplayBackend : public PlatformBackend {
+public:
+	ReplayBackend(const string &trace_file, bool original_timing = false);
+	virtual ~ReplayBackend() override;
+
+	virtual void preempt_activity(shared_ptr<Transition>) override;
+	virtual Clock::time_point time() const noexcept override;
+	virtual void before_step(uint64_t step) override;
+
+	/// @return Number of recorded outcomes that have not been delivered yet.
+	size_t pending() const;
+
+private:
+	struct Outcome {
+		uint64_t step;
+		std::chrono::nanoseconds time;
+		std::chrono::nanoseconds duration;
+		Activity::State state;
+		SensingResult sensing_result;
+	};
+
+	struct Scheduled {
+		shared_ptr<Activity> activity;
+		Outcome outcome;
+		std::chrono::steady_clock::time_point due;
+	};
+
+	virtual void execute_activity(shared_ptr<Activity> a) override;
+
+	void deliver(Scheduled &s);
+	void run_timed();
+
+	static string key(const string &action, const vector<unique_ptr<Value>> &args);
+
+	const bool original_timing_;
+	Clock::time_point start_time_;
+	std::atomic<Clock::rep> last_time_;
+
+	std::unordered_map<string, std::deque<Outcome>> outcomes_;
+	size_t num_outcomes_;
+
+	mutable std::mutex scheduled_mutex_;
+	std::condition_variable scheduled_cond_;
+	std::list<Scheduled> scheduled_;
+	bool running_;
+	std::thread timer_thread_;
+};
+
+
+} // namespace gologpp
+
+#endif // GOLOGPP_REPLAY_BACKEND_H_
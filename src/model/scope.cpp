@@ -9,10 +9,13 @@
 #include "value.h"
 #include "execution.h"
 
+#include <algorithm>
+
 
 namespace gologpp {
 
 Scope Scope::global_scope_;
+thread_local Scope *Scope::thread_global_scope_ = nullptr;
 
 
 Expression *ref_to_global(
@@ -49,6 +52,9 @@ Scope::Scope()
 	BOOST_PP_SEQ_FOR_EACH(GOLOGPP_REGISTER_SIMPLE_TYPE, (), GOLOGPP_PREDEFINED_TYPES)
 
 	(*types_)[*type_] = type_;
+
+	for (const TypesMap::value_type &entry : *types_)
+		predefined_types_[size_t(entry.second->kind())] = entry.second;
 }
 
 
@@ -208,15 +214,120 @@ void Scope::implement_globals(SemanticsFactory &implementor, AExecutionContext &
 void Scope::clear()
 {
 	variables_.clear();
-	if (this == &global_scope()) {
+	if (&parent_scope_ == this) {
 		globals_->clear();
 		domains_->clear();
+		for (unique_ptr<Scope> &module : modules_)
+			module->clear();
+		modules_.clear();
+	}
+}
+
+Scope &Scope::global_scope()
+{ return thread_global_scope_ ? *thread_global_scope_ : global_scope_; }
+
+unique_ptr<Scope> Scope::make_global_scope()
+{ return unique_ptr<Scope>(new Scope()); }
+
+unique_ptr<Scope> Scope::make_module_scope(const vector<const Scope *> &imports) const
+{
+	unique_ptr<Scope> rv(new Scope());
+
+	vector<const Scope *> sources { this };
+	sources.insert(sources.end(), imports.begin(), imports.end());
+	for (const Scope *s : sources) {
+		// Overwrite the module's own predefined types, so that elements of all modules agree on them
+		for (const TypesMap::value_type &entry : *s->types_)
+			(*rv->types_)[entry.first] = entry.second;
+		rv->domains_->insert(s->domains_->begin(), s->domains_->end());
+		rv->globals_->insert(s->globals_->begin(), s->globals_->end());
+	}
+	rv->predefined_types_ = predefined_types_;
+
+	return rv;
+}
+
+
+namespace {
+
+/// @return The entries of @param map that @param target doesn't have, sorted by @param less.
+/// @throw RedefinitionError for the first one (in that order) that @param target has with a different value.
+template<class MapT, class LessT, class ErrorT>
+vector<const typename MapT::value_type *> new_entries(const MapT &map, const MapT &target, LessT less, ErrorT error)
+{
+	using Entry = const typename MapT::value_type *;
+	vector<Entry> entries;
+	for (const typename MapT::value_type &entry : map)
+		entries.push_back(&entry);
+	std::sort(entries.begin(), entries.end(), [&] (Entry lhs, Entry rhs) {
+		return less(lhs->first, rhs->first);
+	} );
+
+	vector<Entry> rv;
+	for (Entry entry : entries) {
+		auto existing = target.find(entry->first);
+		if (existing == target.end())
+			rv.push_back(entry);
+		else if (existing->second != entry->second)
+			throw error(entry->first);
 	}
+	return rv;
+}
+
+} // namespace
+
+
+void Scope::merge(unique_ptr<Scope> &&module)
+{
+	auto name_less = [] (const Name &lhs, const Name &rhs) {
+		return lhs.name() < rhs.name();
+	};
+	auto identifier_less = [] (const Identifier &lhs, const Identifier &rhs) {
+		return lhs.name() < rhs.name() || (lhs.name() == rhs.name() && lhs.arity() < rhs.arity());
+	};
+	auto name_error = [] (const Name &n) {
+		return RedefinitionError(n.name());
+	};
+	auto identifier_error = [] (const Identifier &i) {
+		return RedefinitionError(i.name(), i.arity());
+	};
+
+	// Check everything before changing anything, so a conflict leaves this scope as it was
+	auto types = new_entries(*module->types_, *types_, name_less, name_error);
+	auto domains = new_entries(*module->domains_, *domains_, name_less, name_error);
+	auto globals = new_entries(*module->globals_, *globals_, identifier_less, identifier_error);
+
+	for (auto entry : types)
+		types_->insert(*entry);
+	for (auto entry : domains)
+		domains_->insert(*entry);
+	for (auto entry : globals)
+		globals_->insert(*entry);
+
+	modules_.push_back(std::move(module));
 }
 
+
 Scope &global_scope()
 { return Scope::global_scope(); }
 
+const shared_ptr<const Type> &predefined_type(Type::Kind kind)
+{ return global_scope().predefined_type(kind); }
+
+
+
+GlobalScopeGuard::GlobalScopeGuard(Scope &scope)
+: previous_(Scope::thread_global_scope_)
+{
+	if (&scope.parent_scope() != &scope)
+		throw Bug("GlobalScopeGuard: Not a global scope: " + scope.str());
+	Scope::thread_global_scope_ = &scope;
+}
+
+GlobalScopeGuard::~GlobalScopeGuard()
+{ Scope::thread_global_scope_ = previous_; }
+
+
 bool Scope::exists_global(const string &name, arity_t arity) const
 { return globals_->find( { name, arity } ) != globals_->end(); }
 
@@ -233,6 +344,24 @@ string Scope::to_string(const string &) const
 { return "[" + concat_list(vars(), ", ") + "]"; }
 
 
+unique_ptr<Scope> Scope::redeclare(
+	Global &global,
+	ScopeOwner &owner,
+	Scope *own_scope,
+	const vector<shared_ptr<Variable>> &params
+) {
+	for (arity_t i = 0; i < global.arity(); ++i)
+		if (global.parameter(i)->type() != params[i]->type()) {
+			delete own_scope;
+			throw TypeError("Cannot redefine " + global.signature_str() + " with different parameter types");
+		}
+
+	unique_ptr<Scope> rv = owner.replace_scope(own_scope);
+	global.set_params(params);
+	return rv;
+}
+
+
 void Scope::register_global(Global *g)
 {
 	if (exists_global(g->name(), g->arity()))
@@ -263,6 +392,16 @@ void Scope::register_type(Type *t)
 }
 
 
+const shared_ptr<const Type> &Scope::predefined_type(Type::Kind kind) const
+{
+	if (&parent_scope_ != this)
+		return parent_scope_.predefined_type(kind);
+	if (size_t(kind) >= predefined_types_.size())
+		throw Bug("Not a predefined type kind: " + std::to_string(int(kind)));
+	return predefined_types_[size_t(kind)];
+}
+
+
 Value *Scope::get_symbol(const string &name)
 {
 	for (const DomainsMap::value_type &entry : *domains_) {
@@ -308,6 +447,14 @@ const Scope &ScopeOwner::scope() const
 Scope &ScopeOwner::scope()
 { return *scope_; }
 
+unique_ptr<Scope> ScopeOwner::replace_scope(Scope *owned_scope)
+{
+	unique_ptr<Scope> rv = std::move(scope_);
+	scope_.reset(owned_scope);
+	scope_->set_owner(this);
+	return rv;
+}
+
 
 
 } // namespace gologpp
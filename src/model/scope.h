@@ -1,6 +1,7 @@
 #ifndef GOLOGPP_SCOPE_H_
 #define GOLOGPP_SCOPE_H_
 
+#include <array>
 #include <vector>
 #include <unordered_map>
 #include <boost/optional.hpp>
@@ -53,6 +54,13 @@ public:
 	virtual const Scope &scope() const override;
 	virtual Scope &scope() override;
 
+	/**
+	 * @brief Take ownership of @param owned_scope instead of the current scope, e.g. when a new
+	 * definition has been parsed in it.
+	 * @return The previous scope, which must outlive everything that was defined in it.
+	 */
+	unique_ptr<Scope> replace_scope(Scope *owned_scope);
+
 protected:
 	unique_ptr<Scope> scope_;
 };
@@ -89,8 +97,28 @@ public:
 
 	void attach_semantics(SemanticsFactory &implementor) override;
 
-	static Scope &global_scope()
-	{ return global_scope_; }
+	/// @return The global scope bound to the current thread by a @ref GlobalScopeGuard,
+	/// or the process-wide default scope.
+	static Scope &global_scope();
+
+	/// @return A new, empty global (root) scope that contains only the predefined types.
+	static unique_ptr<Scope> make_global_scope();
+
+	/**
+	 * @brief A new root scope to parse a module into, possibly on another thread.
+	 * It starts out with the types, domains and globals of this root scope and of the
+	 * @param imports, so that the module can refer to them. See @ref merge.
+	 */
+	unique_ptr<Scope> make_module_scope(const vector<const Scope *> &imports = {}) const;
+
+	/**
+	 * @brief Add the types, domains and globals of @param module that aren't in this root scope yet,
+	 * and keep the module scope alive since its elements refer to it.
+	 * Entries are checked in a fixed order (types, domains, globals, each sorted by name), so the
+	 * same conflict is reported no matter how the module was parsed.
+	 * @throw RedefinitionError if the module declares something that this scope already has.
+	 */
+	void merge(unique_ptr<Scope> &&module);
 
 	virtual Scope &scope() override;
 	virtual const Scope &scope() const override;
@@ -161,6 +189,7 @@ public:
 		DefinitionTs... definition_args
 	) {
 		GologT *rv = nullptr;
+		unique_ptr<Scope> old_scope;
 		arity_t arity = static_cast<arity_t>(args.get_value_or({}).size());
 		if (exists_global(name, arity)) {
 			rv = lookup_global<GologT>(name, arity).get();
@@ -169,14 +198,11 @@ public:
 				throw TypeError("Cannot redefine " + rv->str()
 					+ " with type " + type_name);
 
-			// Here be dragons:
-			// own_scope is constructed by the parser, and it may or may not
-			// be the one that is already in use by the existing Global.
-			// If it's not, we have to delete it since it won't be used.
+			// The new definition refers to the variables in own_scope, so it replaces the scope and
+			// params of the existing Global. The Global itself stays, so references to it remain valid.
+			// The old scope is kept until the old definition is gone.
 			if (&(rv->scope()) != own_scope)
-				delete own_scope;
-
-			// TODO: if (rv->defined()): Warn on redefinition
+				old_scope = redeclare(*rv, *rv, own_scope, args.get_value_or({}));
 		}
 		else
 			rv = declare_global<GologT>(own_scope, type_name, name, args);
@@ -203,6 +229,9 @@ public:
 
 	void register_type(Type *t);
 
+	/// @return The predefined type of the given @param kind, see @ref gologpp::predefined_type.
+	const shared_ptr<const Type> &predefined_type(Type::Kind kind) const;
+
 	void register_global(Global *g);
 
 	bool exists_domain(const string &name) const;
@@ -221,7 +250,19 @@ public:
 
 
 private:
+	friend class GlobalScopeGuard;
+
+	/// Make @param global (which is @param owner) use the @param params of a new definition parsed in @param own_scope.
+	/// @return The previous scope of @param global.
+	static unique_ptr<Scope> redeclare(
+		Global &global,
+		ScopeOwner &owner,
+		Scope *own_scope,
+		const vector<shared_ptr<Variable>> &params
+	);
+
 	static Scope global_scope_;
+	static thread_local Scope *thread_global_scope_;
 	Scope &parent_scope_;
 	AbstractLanguageElement *owner_;
 	VariablesMap variables_;
@@ -229,17 +270,36 @@ private:
 	shared_ptr<GlobalsMap> globals_;
 	shared_ptr<DomainsMap> domains_;
 	shared_ptr<TypesMap> types_;
+
+	// Indexed by Type::Kind, only set in a root scope
+	std::array<shared_ptr<const Type>, size_t(Type::Kind::VOID) + 1> predefined_types_;
+
+	// Root scopes of the modules merged into this one
+	vector<unique_ptr<Scope>> modules_;
+};
+
+
+
+/**
+ * @brief Makes @ref global_scope return a different root scope on the current thread while it lives.
+ * That way, several programs can be parsed and executed by independent execution contexts
+ * on different threads. The scope must be made with @ref Scope::make_global_scope.
+ */
+class GlobalScopeGuard {
+public:
+	GlobalScopeGuard(Scope &scope);
+	GlobalScopeGuard(const GlobalScopeGuard &) = delete;
+	~GlobalScopeGuard();
+
+private:
+	Scope *previous_;
 };
 
 
 
 template<class T>
 const T &type()
-{
-	if (!global_scope().exists_type(T::name()))
-		global_scope().register_type(new T());
-	return *global_scope().lookup_type<T>(T::name());
-}
+{ return static_cast<const T &>(*predefined_type(T::static_kind)); }
 
 
 
@@ -0,0 +1,89 @@
+#include "simplification.h"
+#include "scope.h"
+#include "global.h"
+#include "value.h"
+
+namespace gologpp {
+
+
+void Simplification::record(const Expression &original, const Expression &replacement)
+{ changes_.emplace_back(original.str(), replacement.str()); }
+
+const vector<Simplification::Change> &Simplification::changes() const
+{ return changes_; }
+
+size_t Simplification::size() const
+{ return changes_.size(); }
+
+
+string Simplification::to_string(const string &pfx) const
+{
+	string rv;
+	for (const Change &c : changes())
+		rv += pfx + c.first + " => " + c.second + linesep;
+	return rv;
+}
+
+
+
+Simplification simplify(Scope &scope, unique_ptr<Expression> &program)
+{
+	Simplification rv;
+
+	for (const shared_ptr<Global> &g : scope.globals())
+		g->simplify(rv);
+
+	if (program) {
+		Expression *replacement = program->simplify(rv);
+		if (replacement != program.get()) {
+			replacement->set_parent(program->parent());
+			program.reset(replacement);
+		}
+	}
+
+	return rv;
+}
+
+
+
+bool get_number(const Expression &e, Number &n)
+{
+	const Value *v = dynamic_cast<const Value *>(&e);
+	if (!v || !v->type().is<NumberType>())
+		return false;
+
+	const Value::Representation &repr = v->representation();
+	if (const int *i = boost::get<int>(&repr))
+		n = { true, *i, double(*i) };
+	else if (const long *l = boost::get<long>(&repr))
+		n = { true, *l, double(*l) };
+	else if (const double *d = boost::get<double>(&repr))
+		n = { false, long(*d), *d };
+	else
+		return false;
+
+	return true;
+}
+
+
+bool get_bool(const Expression &e, bool &b)
+{
+	const Value *v = dynamic_cast<const Value *>(&e);
+	if (!v || !v->type().is<BoolType>())
+		return false;
+	b = static_cast<bool>(*v);
+	return true;
+}
+
+
+Value *make_value(const Number &n)
+{
+	if (n.integral)
+		return new Value(NumberType::name(), n.l);
+	else
+		return new Value(NumberType::name(), n.d);
+}
+
+
+
+} // namespace gologpp
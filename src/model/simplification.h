@@ -0,0 +1,106 @@
+#ifndef GOLOGPP_SIMPLIFICATION_H_
+#define GOLOGPP_SIMPLIFICATION_H_
+
+#include "gologpp.h"
+#include "expressions.h"
+#include "error.h"
+
+#include <boost/fusion/adapted/std_tuple.hpp>
+#include <boost/fusion/algorithm/iteration/for_each.hpp>
+
+#include <utility>
+
+namespace gologpp {
+
+
+/**
+ * @brief Load-time optimization pass over the object model.
+ *
+ * Folds constant subexpressions, simplifies boolean connectives with a constant operand
+ * and removes dead branches of @ref Conditional statements. Every change is recorded so
+ * that the caller can report what has been simplified.
+ * Must be run before semantics are attached, since replacement expressions have none.
+ */
+class Simplification {
+public:
+	using Change = std::pair<string, string>;
+
+	Simplification() = default;
+
+	void record(const Expression &original, const Expression &replacement);
+
+	/**
+	 * Simplify the expression owned by @param member. If it is replaced, the replacement
+	 * is moved into @param member and the original is deleted.
+	 */
+	template<class ExprT>
+	void simplify_member(std::unique_ptr<ExprT> &member, AbstractLanguageElement &parent)
+	{
+		if (!member)
+			return;
+
+		Expression *replacement = member->simplify(*this);
+		if (replacement == member.get())
+			return;
+
+		ExprT *typed_replacement = dynamic_cast<ExprT *>(replacement);
+		if (!typed_replacement)
+			throw Bug("Simplification of `" + member->str() + "' yields incompatible replacement `"
+				+ replacement->str() + "'");
+		typed_replacement->set_parent(&parent);
+		member.reset(typed_replacement);
+	}
+
+	template<class ExprT>
+	void simplify_member(vector<ExprT> &members, AbstractLanguageElement &parent)
+	{
+		for (ExprT &member : members)
+			simplify_member(member, parent);
+	}
+
+	const vector<Change> &changes() const;
+	size_t size() const;
+
+	string to_string(const string &pfx) const;
+
+private:
+	vector<Change> changes_;
+};
+
+
+
+/**
+ * @brief Run a @ref Simplification over all globals in @param scope and then over @param program.
+ * @param program may itself be replaced.
+ */
+Simplification simplify(Scope &scope, unique_ptr<Expression> &program);
+
+
+
+/**
+ * @brief Numeric content of a @ref Value, if @param e is a numeric @ref Value.
+ */
+struct Number {
+	bool integral;
+	long l;
+	double d;
+};
+
+bool get_number(const Expression &e, Number &n);
+bool get_bool(const Expression &e, bool &b);
+Value *make_value(const Number &n);
+
+
+
+#define DEFINE_SIMPLIFY_WITH_MEMBERS(...) \
+	virtual Expression *simplify(Simplification &s) override { \
+		boost::fusion::for_each(std::tie(__VA_ARGS__), [&] (auto &m) { \
+			s.simplify_member(m, *this); \
+		} ); \
+		return this; \
+	}
+
+
+} // namespace gologpp
+
+#endif // GOLOGPP_SIMPLIFICATION_H_
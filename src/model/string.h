@@ -4,6 +4,7 @@
 #include "expressions.h"
 #include "language.h"
 #include "scope.h"
+#include "simplification.h"
 
 
 namespace gologpp {
@@ -19,6 +20,7 @@ public:
 	const Expression &expression() const;
 
 	DEFINE_ATTACH_SEMANTICS_WITH_MEMBERS(*expr_)
+	DEFINE_SIMPLIFY_WITH_MEMBERS(expr_)
 
 	virtual string to_string(const string &pfx) const override;
 
@@ -36,6 +38,7 @@ public:
 	const Expression &lhs() const;
 
 	DEFINE_ATTACH_SEMANTICS_WITH_MEMBERS(*lhs_, *rhs_)
+	DEFINE_SIMPLIFY_WITH_MEMBERS(lhs_, rhs_)
 
 	virtual string to_string(const string &pfx) const override;
 
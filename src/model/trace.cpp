@@ -0,0 +1,406 @@
+#include "trace.h"
+#include "value.h"
+#include "action.h"
+#include "execution.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstring>
+
+namespace gologpp {
+
+
+static const char trace_magic[8] = { 'G', 'P', 'P', 'T', 'R', 'A', 'C', 'E' };
+static const uint32_t trace_version = 1;
+
+
+namespace {
+
+
+// Assumes a little-endian host, which is all we build on.
+template<class T>
+void put(string &buf, T v)
+{ buf.append(reinterpret_cast<const char *>(&v), sizeof(T)); }
+
+void put_string(string &buf, const string &s)
+{
+	put<uint32_t>(buf, uint32_t(s.size()));
+	buf.append(s);
+}
+
+
+void put_value(string &buf, const Value &v);
+
+struct PutValueVisitor : public boost::static_visitor<void> {
+	string &buf;
+
+	PutValueVisitor(string &buf)
+	: buf(buf)
+	{}
+
+	void operator () (int i) const
+	{ put<int32_t>(buf, i); }
+
+	void operator () (long l) const
+	{ put<int64_t>(buf, l); }
+
+	void operator () (double d) const
+	{ put<double>(buf, d); }
+
+	void operator () (const string &s) const
+	{ put_string(buf, s); }
+
+	void operator () (bool b) const
+	{ put<uint8_t>(buf, b); }
+
+	void operator () (const CompoundType::Representation &c) const
+	{
+		put<uint32_t>(buf, uint32_t(c.size()));
+		for (const auto &field : c) {
+			put_string(buf, field.first);
+			put_value(buf, *field.second);
+		}
+	}
+
+	void operator () (const ListType::Representation &l) const
+	{
+		put<uint32_t>(buf, uint32_t(l.size()));
+		for (const shared_ptr<Value> &elem : l)
+			put_value(buf, *elem);
+	}
+};
+
+void put_value(string &buf, const Value &v)
+{
+	put_string(buf, v.type().name());
+	put<uint8_t>(buf, uint8_t(v.representation().which()));
+	boost::apply_visitor(PutValueVisitor(buf), v.representation());
+}
+
+
+template<class TargetT>
+void put_grounding(string &buf, const Grounding<TargetT> &g)
+{
+	put_string(buf, g.target()->name());
+	put<uint32_t>(buf, uint32_t(g.args().size()));
+	for (const unique_ptr<Value> &arg : g.args())
+		put_value(buf, *arg);
+}
+
+
+
+class Decoder {
+public:
+	Decoder(const string &data, size_t pos, size_t end)
+	: data_(data)
+	, pos_(pos)
+	, end_(end)
+	{}
+
+	template<class T>
+	T get()
+	{
+		T rv;
+		std::memcpy(&rv, bytes(sizeof(T)), sizeof(T));
+		return rv;
+	}
+
+	string get_string()
+	{
+		uint32_t len = get<uint32_t>();
+		return string(bytes(len), len);
+	}
+
+	Value *get_value()
+	{
+		string type_name = get_string();
+		switch (get<uint8_t>()) {
+		case 0:
+			return new Value(type_name, int(get<int32_t>()));
+		case 1:
+			return new Value(type_name, long(get<int64_t>()));
+		case 2:
+			return new Value(type_name, get<double>());
+		case 3:
+			return new Value(type_name, get_string());
+		case 4:
+			return new Value(type_name, bool(get<uint8_t>()));
+		case 5: {
+			uint32_t count = get<uint32_t>();
+			vector<fusion_wtf_vector<string, Value *>> fields;
+			for (uint32_t i = 0; i < count; ++i) {
+				string name = get_string();
+				fields.push_back(fusion_wtf_vector<string, Value *>(name, get_value()));
+			}
+			return new Value(type_name, fields);
+		}
+		case 6: {
+			uint32_t count = get<uint32_t>();
+			vector<Value *> elements;
+			for (uint32_t i = 0; i < count; ++i)
+				elements.push_back(get_value());
+			return new Value(type_name, boost::optional<vector<Value *>>(elements));
+		}
+		}
+		throw TraceError("Invalid value representation in trace");
+	}
+
+	void get_grounding(TraceRecord &rv)
+	{
+		rv.action = get_string();
+		uint32_t arity = get<uint32_t>();
+		rv.args.clear();
+		for (uint32_t i = 0; i < arity; ++i)
+			rv.args.emplace_back(get_value());
+	}
+
+private:
+	const char *bytes(size_t count)
+	{
+		if (end_ - pos_ < count)
+			throw TraceError("Truncated trace record");
+		const char *rv = data_.data() + pos_;
+		pos_ += count;
+		return rv;
+	}
+
+	const string &data_;
+	size_t pos_;
+	size_t end_;
+};
+
+
+} // namespace
+
+
+
+template<class GologT>
+static shared_ptr<GologT> lookup_action(const TraceRecord &r)
+{
+	shared_ptr<GologT> rv = global_scope().lookup_global<GologT>(r.action, arity_t(r.args.size()));
+	if (!rv)
+		throw TraceError("Trace refers to unknown action " + r.action + "/" + std::to_string(r.args.size()));
+	return rv;
+}
+
+
+shared_ptr<Transition> TraceRecord::make_transition() const
+{ return make_pooled<Transition>(lookup_action<Action>(*this), copy(args), hook); }
+
+shared_ptr<ExogEvent> TraceRecord::make_exog_event() const
+{ return make_pooled<ExogEvent>(lookup_action<ExogAction>(*this), copy(args)); }
+
+shared_ptr<Activity> TraceRecord::make_activity()
+{
+	shared_ptr<Activity> rv = make_pooled<Activity>(lookup_action<Action>(*this), copy(args), state);
+	rv->set_sensing_result(std::move(sensing_result));
+	return rv;
+}
+
+
+
+TraceRecorder::TraceRecorder(const string &filename)
+: file_(std::fopen(filename.c_str(), "wb"))
+, start_(std::chrono::steady_clock::now())
+, steps_(0)
+{
+	if (!file_)
+		throw TraceError(filename + ": " + ::strerror(errno));
+
+	string header(trace_magic, sizeof(trace_magic));
+	put<uint32_t>(header, trace_version);
+	put<uint32_t>(header, 0);
+	put<int64_t>(header, std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::system_clock::now().time_since_epoch()
+	).count());
+	std::fwrite(header.data(), 1, header.size(), file_);
+	std::fflush(file_);
+}
+
+
+TraceRecorder::~TraceRecorder()
+{ std::fclose(file_); }
+
+
+void TraceRecorder::write(TraceRecordKind kind, const string &payload)
+{
+	string record;
+	put<uint32_t>(record, uint32_t(sizeof(uint8_t) + sizeof(int64_t) + sizeof(uint64_t) + payload.size()));
+	put<uint8_t>(record, uint8_t(kind));
+	put<int64_t>(record, std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - start_
+	).count());
+	put<uint64_t>(record, steps_);
+	record += payload;
+
+	if (std::fwrite(record.data(), 1, record.size(), file_) != record.size() || std::fflush(file_))
+		throw TraceError(string("Failed to write trace record: ") + ::strerror(errno));
+}
+
+
+void TraceRecorder::record(const Transition &trans)
+{
+	string payload;
+	put<uint8_t>(payload, uint8_t(trans.hook()));
+	put_grounding(payload, trans);
+
+	std::lock_guard<std::mutex> locked(mutex_);
+	write(TraceRecordKind::TRANSITION, payload);
+	++steps_;
+}
+
+
+void TraceRecorder::record(const Grounding<AbstractAction> &exog)
+{
+	string payload;
+	TraceRecordKind kind;
+
+	if (const Activity *a = dynamic_cast<const Activity *>(&exog)) {
+		kind = TraceRecordKind::ACTIVITY;
+		put<uint8_t>(payload, uint8_t(a->state()));
+		put_grounding(payload, *a);
+
+		const SensingResult &sr = a->sensing_result();
+		if (sr.is_numeric_array()) {
+			put<uint8_t>(payload, 2);
+			put<uint32_t>(payload, uint32_t(sr.numbers().size()));
+			payload.append(
+				reinterpret_cast<const char *>(sr.numbers().data()),
+				sr.numbers().size() * sizeof(double)
+			);
+		}
+		else if (sr) {
+			put<uint8_t>(payload, 1);
+			put_value(payload, *sr.value());
+		}
+		else
+			put<uint8_t>(payload, 0);
+	}
+	else if (const ExogEvent *e = dynamic_cast<const ExogEvent *>(&exog)) {
+		kind = TraceRecordKind::EXOG_EVENT;
+		put_grounding(payload, *e);
+	}
+	else
+		throw Bug("Unknown element in the exogenous event queue: " + exog.str());
+
+	std::lock_guard<std::mutex> locked(mutex_);
+	write(kind, payload);
+}
+
+
+
+TraceReader::TraceReader(const string &filename)
+: pos_(0)
+{
+	std::ifstream file(filename, std::ios::binary);
+	if (!file.is_open())
+		throw TraceError(filename + ": " + ::strerror(errno));
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+	data_ = buffer.str();
+
+	Decoder header(data_, 0, data_.size());
+	const size_t header_size = sizeof(trace_magic) + 2 * sizeof(uint32_t) + sizeof(int64_t);
+	if (data_.size() < header_size || data_.compare(0, sizeof(trace_magic), trace_magic, sizeof(trace_magic)))
+		throw TraceError(filename + ": Not a golog++ trace");
+	header.get<uint64_t>(); // magic
+	uint32_t version = header.get<uint32_t>();
+	if (version != trace_version)
+		throw TraceError(filename + ": Unsupported trace version " + std::to_string(version));
+	header.get<uint32_t>();
+	start_time_ = std::chrono::system_clock::time_point(
+		std::chrono::duration_cast<std::chrono::system_clock::duration>(
+			std::chrono::nanoseconds(header.get<int64_t>())
+		)
+	);
+	pos_ = header_size;
+}
+
+
+std::chrono::system_clock::time_point TraceReader::start_time() const
+{ return start_time_; }
+
+
+bool TraceReader::next(TraceRecord &rv)
+{
+	if (pos_ == data_.size())
+		return false;
+
+	Decoder size_decoder(data_, pos_, data_.size());
+	uint32_t size = size_decoder.get<uint32_t>();
+	size_t begin = pos_ + sizeof(uint32_t);
+	if (data_.size() - begin < size)
+		throw TraceError("Truncated trace record");
+	pos_ = begin + size;
+
+	Decoder d(data_, begin, pos_);
+	rv.kind = TraceRecordKind(d.get<uint8_t>());
+	rv.time = std::chrono::nanoseconds(d.get<int64_t>());
+	rv.step = d.get<uint64_t>();
+	rv.sensing_result = SensingResult();
+
+	switch (rv.kind) {
+	case TraceRecordKind::TRANSITION:
+		rv.hook = Transition::Hook(d.get<uint8_t>());
+		d.get_grounding(rv);
+		return true;
+	case TraceRecordKind::EXOG_EVENT:
+		d.get_grounding(rv);
+		return true;
+	case TraceRecordKind::ACTIVITY:
+		rv.state = Activity::State(d.get<uint8_t>());
+		d.get_grounding(rv);
+		switch (d.get<uint8_t>()) {
+		case 0:
+			break;
+		case 1:
+			rv.sensing_result = SensingResult(d.get_value());
+			break;
+		case 2: {
+			vector<double> numbers(d.get<uint32_t>());
+			for (double &n : numbers)
+				n = d.get<double>();
+			rv.sensing_result = SensingResult(std::move(numbers));
+			break;
+		}
+		default:
+			throw TraceError("Invalid sensing result in trace");
+		}
+		return true;
+	}
+
+	throw TraceError("Invalid trace record kind " + std::to_string(int(rv.kind)));
+}
+
+
+
+TraceReplay::TraceReplay(const string &filename)
+: reader_(filename)
+, done_(false)
+{ advance(); }
+
+
+void TraceReplay::advance()
+{
+	while (reader_.next(next_))
+		if (next_.kind == TraceRecordKind::EXOG_EVENT)
+			return;
+	done_ = true;
+}
+
+
+void TraceReplay::feed(AExecutionContext &ctx, uint64_t step)
+{
+	while (!done_ && next_.step <= step) {
+		ctx.exog_queue_push(next_.make_exog_event());
+		advance();
+	}
+}
+
+
+bool TraceReplay::done() const
+{ return done_; }
+
+
+
+} // namespace gologpp
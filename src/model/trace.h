@@ -0,0 +1,150 @@
+#ifndef GOLOGPP_TRACE_H_
+#define GOLOGPP_TRACE_H_
+
+#include "gologpp.h"
+#include "transition.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+
+namespace gologpp {
+
+
+/*
+ * Binary execution trace format (version 1). All integers are little-endian.
+ *
+ * Header:  char[8] "GPPTRACE", uint32 version, uint32 reserved,
+ *          int64 wall clock time at the start of the trace in ns since the epoch
+ * Records: uint32 size of the rest of the record, uint8 kind, int64 ns since the start of the trace,
+ *          uint64 number of transitions before this record, payload
+ *
+ * Payloads:
+ *   TRANSITION: uint8 hook, grounding
+ *   EXOG_EVENT: grounding
+ *   ACTIVITY:   uint8 state, grounding, uint8 sensing result kind (0 none, 1 value, 2 numbers),
+ *               value | uint32 count, count * double
+ *
+ *   grounding:  string action name, uint32 arity, arity * value
+ *   value:      string type name, uint8 representation index (see Value::Representation), then
+ *               int32 | int64 | double | string | uint8 | uint32 count, count * (string name, value)
+ *               | uint32 count, count * value
+ *   string:     uint32 length, bytes
+ *
+ * Records are only ever appended and can be skipped by their size without decoding the payload.
+ */
+
+
+class TraceError : public std::runtime_error {
+	using std::runtime_error::runtime_error;
+};
+
+
+enum class TraceRecordKind : uint8_t {
+	TRANSITION = 1,
+	EXOG_EVENT = 2,
+	ACTIVITY = 3
+};
+
+
+
+/**
+ * @brief A decoded trace record. Which of the members are meaningful depends on @a kind.
+ */
+struct TraceRecord {
+	TraceRecordKind kind;
+	std::chrono::nanoseconds time; ///< Since the start of the trace
+	uint64_t step; ///< Number of transitions recorded before this record
+	string action;
+	vector<unique_ptr<Value>> args;
+	Transition::Hook hook; ///< TRANSITION only
+	Activity::State state; ///< ACTIVITY only
+	SensingResult sensing_result; ///< ACTIVITY only
+
+	/// @return The recorded transition, its action looked up in the global scope.
+	shared_ptr<Transition> make_transition() const;
+
+	/// @return The recorded exogenous event, its action looked up in the global scope.
+	shared_ptr<ExogEvent> make_exog_event() const;
+
+	/// @return The recorded activity state. Moves the sensing result out of this record.
+	shared_ptr<Activity> make_activity();
+};
+
+
+
+/**
+ * @brief Appends every transition, exogenous event and activity state change that an
+ * @ref ExecutionContext processes to a binary trace file.
+ * Each record is written and flushed as a whole, so a trace stays readable if the process dies.
+ */
+class TraceRecorder {
+public:
+	TraceRecorder(const string &filename);
+	TraceRecorder(const TraceRecorder &) = delete;
+	~TraceRecorder();
+
+	void record(const Transition &trans);
+
+	/// Record an element of the exogenous event queue, i.e. either an @ref ExogEvent or an @ref Activity.
+	void record(const Grounding<AbstractAction> &exog);
+
+private:
+	void write(TraceRecordKind kind, const string &payload);
+
+	std::FILE *file_;
+	std::mutex mutex_;
+	std::chrono::steady_clock::time_point start_;
+	uint64_t steps_;
+};
+
+
+
+class TraceReader {
+public:
+	TraceReader(const string &filename);
+
+	std::chrono::system_clock::time_point start_time() const;
+
+	/// Decode the next record into @param rv.
+	/// @return false at the end of the trace.
+	bool next(TraceRecord &rv);
+
+private:
+	string data_;
+	size_t pos_;
+	std::chrono::system_clock::time_point start_time_;
+};
+
+
+
+/**
+ * @brief Feeds the exogenous events from a trace back into an execution context.
+ * An event is pushed right before the transition it originally preceded, so that a replay
+ * with the same program and platform behaviour takes the same transitions.
+ */
+class TraceReplay {
+public:
+	TraceReplay(const string &filename);
+
+	/// Push all recorded exogenous events that happened before transition number @param step.
+	void feed(AExecutionContext &ctx, uint64_t step);
+
+	/// @return Whether all recorded exogenous events have been pushed.
+	bool done() const;
+
+private:
+	void advance();
+
+	TraceReader reader_;
+	TraceRecord next_;
+	bool done_;
+};
+
+
+
+} // namespace gologpp
+
+#endif // GOLOGPP_TRACE_H_
@@ -14,6 +14,12 @@ Transition::Transition(const shared_ptr<Action> &action, vector<unique_ptr<Value
 Transition::Hook Transition::hook() const
 { return hook_; }
 
+ActivityId Transition::activity_id() const
+{ return activity_id_; }
+
+void Transition::set_activity_id(ActivityId id)
+{ activity_id_ = id; }
+
 void Transition::attach_semantics(SemanticsFactory &implementor)
 {
 	if (!semantics_) {
@@ -43,6 +49,55 @@ string to_string(Transition::Hook h)
 
 
 
+SensingResult::SensingResult(Value *value)
+: value_(value)
+{}
+
+SensingResult::SensingResult(vector<double> &&numbers)
+: numbers_(std::move(numbers))
+, is_numeric_array_(true)
+{}
+
+// Not defaulted because unique_ptr<Value> deep-copies instead of moving
+SensingResult::SensingResult(SensingResult &&other)
+: value_(other.value_.release())
+, numbers_(std::move(other.numbers_))
+, is_numeric_array_(other.is_numeric_array_)
+{ other.is_numeric_array_ = false; }
+
+SensingResult &SensingResult::operator = (SensingResult &&other)
+{
+	value_.reset(other.value_.release());
+	numbers_ = std::move(other.numbers_);
+	is_numeric_array_ = other.is_numeric_array_;
+	other.is_numeric_array_ = false;
+	return *this;
+}
+
+SensingResult::operator bool () const
+{ return value_ || is_numeric_array_; }
+
+bool SensingResult::is_numeric_array() const
+{ return is_numeric_array_; }
+
+Value *SensingResult::value() const
+{ return value_.get(); }
+
+const vector<double> &SensingResult::numbers() const
+{ return numbers_; }
+
+string SensingResult::str() const
+{
+	if (value_)
+		return value_->str();
+	else if (is_numeric_array_)
+		return "[" + std::to_string(numbers_.size()) + " numbers]";
+	else
+		return "<none>";
+}
+
+
+
 Activity::Activity(const shared_ptr<Action> &action, vector<unique_ptr<Value>> &&args, State state)
 : Grounding<Action>(action, std::move(args))
 , state_(state)
@@ -51,6 +106,7 @@ Activity::Activity(const shared_ptr<Action> &action, vector<unique_ptr<Value>> &
 Activity::Activity(const shared_ptr<Transition> &trans)
 : Grounding<Action>(trans->target(), copy(trans->args()))
 , state_(State::IDLE)
+, activity_id_(trans->activity_id())
 {
 	if (trans->hook() != Transition::Hook::START)
 		throw Bug("Activity must be constructed from a START Transition");
@@ -62,8 +118,18 @@ void Activity::set_state(Activity::State state)
 Activity::State Activity::state() const
 { return state_; }
 
+ActivityId Activity::activity_id() const
+{ return activity_id_; }
+
+void Activity::set_activity_id(ActivityId id)
+{ activity_id_ = id; }
+
 shared_ptr<Transition> Activity::transition(Transition::Hook hook)
-{ return std::make_shared<Transition>(target(), copy(args()), hook); }
+{
+	shared_ptr<Transition> rv = make_pooled<Transition>(target(), copy(args()), hook);
+	rv->set_activity_id(activity_id_);
+	return rv;
+}
 
 
 Value Activity::mapped_arg_value(const string &name) const
@@ -96,13 +162,13 @@ void Activity::attach_semantics(SemanticsFactory &implementor)
 	}
 }
 
-void Activity::set_sensing_result(Value *sr)
-{ sensing_result_.reset(sr); }
+void Activity::set_sensing_result(SensingResult &&sr)
+{ sensing_result_ = std::move(sr); }
 
-unique_ptr<Value> &Activity::sensing_result()
+SensingResult &Activity::sensing_result()
 { return sensing_result_; }
 
-const unique_ptr<Value> &Activity::sensing_result() const
+const SensingResult &Activity::sensing_result() const
 { return sensing_result_; }
 
 
@@ -5,10 +5,17 @@
 #include "scope.h"
 #include "reference.h"
 #include "action.h"
+#include "object_pool.h"
+
+#include <cstdint>
 
 namespace gologpp {
 
 
+/// Assigned by the @ref PlatformBackend when an activity starts. 0 means none.
+using ActivityId = uint64_t;
+
+
 
 class Transition : public Grounding<Action>, public LanguageElement<Transition> {
 public:
@@ -18,12 +25,17 @@ public:
 
 	Hook hook() const;
 
+	/// @return The id of the activity this transition belongs to, or 0 if it came from the history.
+	ActivityId activity_id() const;
+	void set_activity_id(ActivityId id);
+
 	virtual string to_string(const string &pfx) const override;
 
 	virtual void attach_semantics(SemanticsFactory &) override;
 
 private:
 	Hook hook_;
+	ActivityId activity_id_ = 0;
 };
 
 
@@ -32,6 +44,40 @@ string to_string(Transition::Hook);
 
 
 
+/**
+ * @brief Move-only sensing result that a @ref PlatformBackend hands to the history.
+ * Holds either a @ref Value or a plain numeric array for bulk data such as laser scans.
+ * A numeric array is moved through unchanged and is never converted into a @ref Value tree.
+ */
+class SensingResult {
+public:
+	SensingResult() = default;
+	SensingResult(Value *value);
+	SensingResult(vector<double> &&numbers);
+
+	SensingResult(SensingResult &&);
+	SensingResult &operator = (SensingResult &&);
+	SensingResult(const SensingResult &) = delete;
+	SensingResult &operator = (const SensingResult &) = delete;
+
+	/// @return Whether there is any sensing result.
+	explicit operator bool () const;
+	bool is_numeric_array() const;
+
+	/// @return The value, or nullptr if this is empty or a numeric array.
+	Value *value() const;
+	const vector<double> &numbers() const;
+
+	string str() const;
+
+private:
+	unique_ptr<Value> value_;
+	vector<double> numbers_;
+	bool is_numeric_array_ = false;
+};
+
+
+
 class Activity : public Grounding<Action>, public LanguageElement<Activity> {
 public:
 	enum State { IDLE, RUNNING, FINAL, PREEMPTED, FAILED };
@@ -42,6 +88,10 @@ public:
 	State state() const;
 	void set_state(State s);
 
+	ActivityId activity_id() const;
+	void set_activity_id(ActivityId id);
+
+	/// @return A transition of this activity that carries its @ref activity_id.
 	shared_ptr<Transition> transition(Transition::Hook hook);
 
 	const std::string &mapped_name() const;
@@ -51,13 +101,14 @@ public:
 
 	virtual void attach_semantics(SemanticsFactory &) override;
 
-	void set_sensing_result(Value *);
-	unique_ptr<Value> &sensing_result();
-	const unique_ptr<Value> &sensing_result() const;
+	void set_sensing_result(SensingResult &&);
+	SensingResult &sensing_result();
+	const SensingResult &sensing_result() const;
 
 private:
 	State state_;
-	unique_ptr<Value> sensing_result_;
+	ActivityId activity_id_ = 0;
+	SensingResult sensing_result_;
 };
 
 
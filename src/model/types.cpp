@@ -1,6 +1,8 @@
 #include "types.h"
 #include "scope.h"
 
+#include <atomic>
+
 namespace gologpp {
 
 
@@ -11,12 +13,17 @@ void ensure_type_equality(const AbstractLanguageElement &e1, const AbstractLangu
 }
 
 
-Type::Type(const string &name)
+static std::atomic<TypeId> next_type_id { 1 };
+
+
+Type::Type(Kind kind, const string &name)
 : Name(name)
+, kind_(kind)
+, id_(next_type_id++)
 {}
 
 bool Type::operator == (const Type &other) const
-{ return this == &other || typeid(*this) == typeid(other) || other.is<UndefinedType>(); }
+{ return this == &other || kind_ == other.kind_ || other.is<UndefinedType>(); }
 
 bool Type::operator == (const string &type_name) const
 { return name() == type_name || type_name == UndefinedType::name(); }
@@ -36,6 +43,12 @@ bool Type::is_compound() const
 bool Type::is_simple() const
 { return !is_compound(); }
 
+Type::Kind Type::kind() const
+{ return kind_; }
+
+TypeId Type::id() const
+{ return id_; }
+
 void Type::ensure_match(const AbstractLanguageElement &e) const
 {
 	if (e.type() == *this)
@@ -44,8 +57,10 @@ void Type::ensure_match(const AbstractLanguageElement &e) const
 
 
 
+constexpr Type::Kind UndefinedType::static_kind;
+
 UndefinedType::UndefinedType()
-: Type(name())
+: Type(static_kind, name())
 {}
 
 bool UndefinedType::operator == (const Type &) const
@@ -66,8 +81,10 @@ string UndefinedType::name()
 
 
 
+constexpr Type::Kind BoolType::static_kind;
+
 BoolType::BoolType()
-: Type(name())
+: Type(static_kind, name())
 {}
 
 string BoolType::name()
@@ -75,8 +92,10 @@ string BoolType::name()
 
 
 
+constexpr Type::Kind NumberType::static_kind;
+
 NumberType::NumberType()
-: Type(name())
+: Type(static_kind, name())
 {}
 
 string NumberType::name()
@@ -84,8 +103,10 @@ string NumberType::name()
 
 
 
+constexpr Type::Kind StringType::static_kind;
+
 StringType::StringType()
-: Type(name())
+: Type(static_kind, name())
 {}
 
 string StringType::name()
@@ -93,8 +114,10 @@ string StringType::name()
 
 
 
+constexpr Type::Kind SymbolType::static_kind;
+
 SymbolType::SymbolType()
-: Type(name())
+: Type(static_kind, name())
 {}
 
 string SymbolType::name()
@@ -102,8 +125,10 @@ string SymbolType::name()
 
 
 
+constexpr Type::Kind VoidType::static_kind;
+
 VoidType::VoidType()
-: Type(name())
+: Type(static_kind, name())
 {}
 
 string VoidType::name()
@@ -111,8 +136,10 @@ string VoidType::name()
 
 
 
+constexpr Type::Kind CompoundType::static_kind;
+
 CompoundType::CompoundType(const string &name)
-: Type(name)
+: Type(static_kind, name)
 {}
 
 string CompoundType::name()
@@ -159,8 +186,10 @@ bool CompoundType::is_compound() const
 
 
 
+constexpr Type::Kind ListType::static_kind;
+
 ListType::ListType(const Type &elem_type)
-: Type("list[" + elem_type.name() + "]")
+: Type(static_kind, "list[" + elem_type.name() + "]")
 , elem_type_(elem_type)
 {}
 
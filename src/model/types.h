@@ -5,18 +5,91 @@
 #include "user_error.h"
 #include "utilities.h"
 
+#include <cstdint>
 #include <unordered_map>
 
 namespace gologpp {
 
 
+/// Identifies a @ref Type object with a small integer, see @ref Type::id.
+using TypeId = uint32_t;
+
+
 void ensure_type_equality(const AbstractLanguageElement &e1, const AbstractLanguageElement &e2);
 
 
+bool elements_equal(const vector<shared_ptr<Value>> &lhs, const vector<shared_ptr<Value>> &rhs);
+bool elements_equal(
+	const std::unordered_map<string, shared_ptr<Value>> &lhs,
+	const std::unordered_map<string, shared_ptr<Value>> &rhs
+);
+
+
+/**
+ * @brief Copy-on-write container of shared @ref Value s, used to represent list and compound values.
+ * Copies share both the container and its elements, so copying a @ref Value is O(1) instead of a deep
+ * clone. Modifying a shared container through @ref mutate only copies its spine, i.e. the element
+ * pointers. Unchanged elements stay shared between all copies.
+ */
+template<class ContainerT>
+class SharedRepresentation {
+public:
+	using const_iterator = typename ContainerT::const_iterator;
+
+	SharedRepresentation()
+	: data_(std::make_shared<ContainerT>())
+	{}
+
+	SharedRepresentation(ContainerT &&data)
+	: data_(std::make_shared<ContainerT>(std::move(data)))
+	{}
+
+	const ContainerT &operator * () const
+	{ return *data_; }
+
+	const ContainerT *operator -> () const
+	{ return data_.get(); }
+
+	const_iterator begin() const
+	{ return data_->begin(); }
+
+	const_iterator end() const
+	{ return data_->end(); }
+
+	size_t size() const
+	{ return data_->size(); }
+
+	bool empty() const
+	{ return data_->empty(); }
+
+	/// @return The container for modification, after unsharing it if it is shared with other copies.
+	ContainerT &mutate()
+	{
+		if (data_.use_count() > 1)
+			data_ = std::make_shared<ContainerT>(*data_);
+		return *data_;
+	}
+
+	bool operator == (const SharedRepresentation<ContainerT> &other) const
+	{ return data_ == other.data_ || elements_equal(*data_, *other.data_); }
+
+	bool operator != (const SharedRepresentation<ContainerT> &other) const
+	{ return !(*this == other); }
+
+private:
+	shared_ptr<ContainerT> data_;
+};
+
+
 class Type
 : public std::enable_shared_from_this<Type>
 , public Name {
 public:
+	/// The class of a type, so that type checks compare integers instead of typeid s.
+	enum class Kind : uint8_t {
+		UNDEFINED, BOOL, NUMBER, STRING, SYMBOL, VOID, COMPOUND, LIST
+	};
+
 	virtual ~Type() = default;
 
 	virtual bool operator == (const Type &other) const;
@@ -31,21 +104,36 @@ public:
 	template<class T>
 	bool is() const;
 
+	Kind kind() const;
+
+	/// @return A process-wide unique id that is assigned when the type is created.
+	TypeId id() const;
+
 	void ensure_match(const AbstractLanguageElement &e) const;
 
 protected:
-	Type(const string &name);
+	Type(Kind kind, const string &name);
+
+private:
+	const Kind kind_;
+	const TypeId id_;
 };
 
 
 template<class T>
 bool Type::is() const
-{ return typeid(*this) == typeid(T); }
+{ return kind_ == T::static_kind; }
+
+
+/// @return The instance of a predefined type in the current global scope, without looking it up by name.
+const shared_ptr<const Type> &predefined_type(Type::Kind kind);
 
 
 
 class UndefinedType : public Type {
 public:
+	static constexpr Kind static_kind = Kind::UNDEFINED;
+
 	UndefinedType();
 
 	virtual bool operator == (const Type &other) const override;
@@ -59,6 +147,8 @@ public:
 
 class BoolType : public Type {
 public:
+	static constexpr Kind static_kind = Kind::BOOL;
+
 	BoolType();
 	static string name();
 };
@@ -67,6 +157,8 @@ public:
 
 class NumberType : public Type {
 public:
+	static constexpr Kind static_kind = Kind::NUMBER;
+
 	NumberType();
 	static string name();
 };
@@ -75,6 +167,8 @@ public:
 
 class StringType : public Type {
 public:
+	static constexpr Kind static_kind = Kind::STRING;
+
 	StringType();
 	static string name();
 };
@@ -83,6 +177,8 @@ public:
 
 class SymbolType : public Type {
 public:
+	static constexpr Kind static_kind = Kind::SYMBOL;
+
 	SymbolType();
 	static string name();
 };
@@ -91,6 +187,8 @@ public:
 
 class VoidType : public Type {
 public:
+	static constexpr Kind static_kind = Kind::VOID;
+
 	VoidType();
 	static string name();
 };
@@ -99,7 +197,9 @@ public:
 
 class CompoundType : public Type {
 public:
-	using Representation = std::unordered_map<string, unique_ptr<Value>>;
+	static constexpr Kind static_kind = Kind::COMPOUND;
+
+	using Representation = SharedRepresentation<std::unordered_map<string, shared_ptr<Value>>>;
 
 	CompoundType(const string &name);
 
@@ -136,7 +236,9 @@ private:
 
 class ListType : public Type {
 public:
-	using Representation = vector<unique_ptr<Value>>;
+	static constexpr Kind static_kind = Kind::LIST;
+
+	using Representation = SharedRepresentation<vector<shared_ptr<Value>>>;
 
 	ListType(const Type &elem_type);
 	ListType(const string &elem_type_name);
@@ -1,4 +1,5 @@
 #include "value.h"
+#include "object_pool.h"
 
 #include <boost/functional/hash.hpp>
 #include <boost/fusion/include/at_c.hpp>
@@ -108,6 +109,22 @@ bool Value::operator != (const Value &other) const
 { return !(*this == other); }
 
 
+void *Value::operator new(size_t size)
+{
+	if (size == sizeof(Value))
+		return BlockPool::instance<sizeof(Value)>().allocate();
+	return ::operator new(size);
+}
+
+void Value::operator delete(void *p, size_t size)
+{
+	if (size == sizeof(Value))
+		BlockPool::instance<sizeof(Value)>().deallocate(p);
+	else
+		::operator delete(p);
+}
+
+
 Value::Value(Representation &&l)
 : representation_(std::move(l))
 {}
@@ -148,7 +165,7 @@ Value::Value(const string &type_name, const vector<fusion_wtf_vector<string, Val
 			+ type_name + "\" does not refer to a compound type");
 
 	const CompoundType &this_type = dynamic_cast<const CompoundType &>(type());
-	CompoundType::Representation tmp_value;
+	std::unordered_map<string, shared_ptr<Value>> tmp_value;
 	for (const boost::fusion::vector<string, Value *> &v : compound_values) {
 		const string &field_name = boost::fusion::at_c<0>(v);
 		const Type &field_type = this_type.field_type(field_name);
@@ -161,7 +178,7 @@ Value::Value(const string &type_name, const vector<fusion_wtf_vector<string, Val
 			);
 	}
 
-	representation_ = std::move(tmp_value);
+	representation_ = CompoundType::Representation(std::move(tmp_value));
 
 	// TODO: check if all fields have been assigned!
 }
@@ -175,13 +192,18 @@ Value::Value(const string &type_name, const boost::optional<vector<Value *>> &li
 		throw TypeError("Attempt to construct list value, but type name \""
 			+ type_name + "\" does not refer to a list type");
 
-	ListType::Representation list_repr;
+	vector<shared_ptr<Value>> list_repr;
 	for (Value *v : list_values.get_value_or({}))
 		list_repr.emplace_back(v);
-	representation_ = std::move(list_repr);
+	representation_ = ListType::Representation(std::move(list_repr));
 }
 
 
+Value::Value(const Type &type, Representation &&repr)
+: representation_(std::move(repr))
+{ set_type(type); }
+
+
 Value::Value(Value &&c)
 {
 	semantics_ = std::move(c.semantics_);
@@ -235,7 +257,7 @@ Value *Value::copy() const
 
 bool Value::operator == (const Value &c) const
 {
-	return this->type() == c.type()
+	return (type_id() == c.type_id() || type() == c.type())
 		&& representation() == c.representation();
 }
 
@@ -250,6 +272,33 @@ void Value::attach_semantics(SemanticsFactory &f)
 
 
 
+bool elements_equal(const vector<shared_ptr<Value>> &lhs, const vector<shared_ptr<Value>> &rhs)
+{
+	if (lhs.size() != rhs.size())
+		return false;
+	for (size_t i = 0; i < lhs.size(); ++i)
+		if (lhs[i] != rhs[i] && *lhs[i] != *rhs[i])
+			return false;
+	return true;
+}
+
+
+bool elements_equal(
+	const std::unordered_map<string, shared_ptr<Value>> &lhs,
+	const std::unordered_map<string, shared_ptr<Value>> &rhs
+) {
+	if (lhs.size() != rhs.size())
+		return false;
+	for (const auto &pair : lhs) {
+		auto it = rhs.find(pair.first);
+		if (it == rhs.end() || (it->second != pair.second && *it->second != *pair.second))
+			return false;
+	}
+	return true;
+}
+
+
+
 vector<unique_ptr<Value>> copy(const vector<unique_ptr<Value>> &v)
 {
 	vector<unique_ptr<Value>> rv;
@@ -61,6 +61,10 @@ public:
 
 	Value(const string &type_name, const vector<fusion_wtf_vector<string, Value *>> &compound_values);
 	Value(const string &type_name, const boost::optional<vector<Value *>> &list_values);
+
+	/// Construct a value of an already resolved @param type, without looking it up by name.
+	Value(const Type &type, Representation &&repr);
+
 	Value(Value &&c);
 	Value(const Value &c);
 
@@ -69,6 +73,10 @@ public:
 
 	virtual ~Value() override;
 
+	/// Values are taken from a @ref BlockPool, since every grounding copies its arguments.
+	static void *operator new(size_t size);
+	static void operator delete(void *p, size_t size);
+
 	virtual size_t hash() const;
 
 	operator int () const
@@ -52,7 +52,7 @@ ActionDefinitionParser<Action>::ActionDefinitionParser()
 		^ ( "mapping:" > mapping(*_r2) )
 		^ qi::eps
 	) > '}' ) [
-		phoenix::bind(
+		_val = phoenix::bind(
 			&Scope::define_global<
 				Action,
 				boost::optional<Expression *>,
@@ -61,7 +61,7 @@ ActionDefinitionParser<Action>::ActionDefinitionParser()
 				boost::optional<ActionMapping *>
 			>,
 			_r1,
-			_r2, val(""), _r3, _r4, _1, _2, _3, _4
+			_r2, val(VoidType::name()), _r3, _r4, _1, _2, _3, _4
 		)
 	];
 
@@ -85,7 +85,7 @@ ActionDefinitionParser<ExogAction>::ActionDefinitionParser()
 		^ ( "mapping:" > mapping(*_r2) )
 		^ qi::eps
 	) > '}' ) [
-		phoenix::bind(
+		_val = phoenix::bind(
 			&Scope::define_global<
 				ExogAction,
 				boost::optional<Expression *>,
@@ -93,7 +93,7 @@ ActionDefinitionParser<ExogAction>::ActionDefinitionParser()
 				boost::optional<ActionMapping *>
 			>,
 			_r1,
-			_r2, val(""), _r3, _r4, _1, _2, _3
+			_r2, val(VoidType::name()), _r3, _r4, _1, _2, _3
 		)
 	];
 
@@ -120,9 +120,11 @@ ActionParser<ActionT>::ActionParser()
 		]
 	)
 	> (
-		action_definition(_r1, _a, _b, _c)
+		action_definition(_r1, _a, _b, _c) [
+			_val = _1
+		]
 		| lit(';') [
-			phoenix::bind(&Scope::declare_global<ActionT>, _r1, _a, val(""), _b, _c)
+			_val = phoenix::bind(&Scope::declare_global<ActionT>, _r1, _a, val(VoidType::name()), _b, _c)
 		]
 	);
 	action.name("action_declaration");
@@ -16,7 +16,7 @@ namespace parser {
 
 template<class ActionT>
 struct ActionDefinitionParser
-: grammar < void (
+: grammar < ActionT *(
 	Scope &, // parent scope
 	Scope *, // owned scope
 	string, // action name
@@ -25,7 +25,7 @@ struct ActionDefinitionParser
 	ActionDefinitionParser();
 
 
-	rule < void (
+	rule < ActionT *(
 		Scope &, // parent scope
 		Scope *, // owned scope
 		string, // action name
@@ -13,6 +13,7 @@
 
 #include <boost/spirit/include/qi_kleene.hpp>
 #include <boost/spirit/include/qi_omit.hpp>
+#include <boost/spirit/include/qi_action.hpp>
 #include <boost/spirit/include/qi_alternative.hpp>
 #include <boost/spirit/include/qi_sequence.hpp>
 #include <boost/spirit/include/qi_expect.hpp>
@@ -20,6 +21,7 @@
 #include <boost/spirit/home/qi/nonterminal/error_handler.hpp>
 
 #include <boost/phoenix/bind/bind_function.hpp>
+#include <boost/phoenix/stl/container.hpp>
 
 namespace gologpp {
 namespace parser {
@@ -29,7 +31,8 @@ struct ProgramParser : grammar<Expression *(Scope &)> {
 	ProgramParser()
 	: ProgramParser::base_type(program)
 	{
-		program = *( omit[ // Discard attributes, they just register themselves as Globals
+		// Imports are resolved by parse_file before the program is parsed
+		program = *omit[import_directive()] >> *( omit[ // Discard attributes, they just register themselves as Globals
 			fluent(_r1)
 			| action(_r1)
 			| exog_action(_r1)
@@ -62,6 +65,43 @@ struct ProgramParser : grammar<Expression *(Scope &)> {
 
 
 
+/**
+ * @brief Parses an imported file: Only declarations, no program. The attribute holds
+ * the globals that were declared or defined, in order.
+ */
+struct ModuleParser : grammar<vector<Global *>(Scope &)> {
+	ModuleParser()
+	: ModuleParser::base_type(module)
+	{
+		module = *omit[import_directive()] >> *(
+			fluent(_r1) [ phoenix::push_back(_val, _1) ]
+			| action(_r1) [ phoenix::push_back(_val, _1) ]
+			| exog_action(_r1) [ phoenix::push_back(_val, _1) ]
+			| function(_r1) [ phoenix::push_back(_val, _1) ]
+			| omit[domain_decl()(_r1)]
+			| omit[type_definition(_r1)]
+		) > eoi;
+
+		on_error<rethrow>(module,
+			phoenix::bind(&handle_error, _1, _3, _2, _4)
+		);
+
+		initialize_cyclic_expressions();
+		initialize_cyclic_literals();
+
+		GOLOGPP_DEBUG_NODE(module);
+	}
+
+	rule<vector<Global *>(Scope &)> module;
+	ActionParser<Action> action;
+	ActionParser<ExogAction> exog_action;
+	FunctionParser function;
+	TypeDefinitionParser type_definition;
+	FluentParser fluent;
+};
+
+
+
 } // namespace parser
 } // namespace gologpp
 
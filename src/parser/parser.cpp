@@ -1,10 +1,29 @@
-#include <fstream>
 #include <chrono>
 #include <iostream>
+#include <map>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "grammar.h"
 #include "parser.h"
 
+#include <model/error.h>
+#include <model/fluent.h>
+#include <model/types.h>
+
 #include <boost/phoenix/core/reference.hpp>
 
 
@@ -12,40 +31,389 @@ namespace gologpp {
 namespace parser {
 
 
+namespace {
 
-unique_ptr<Expression> parse_string(const std::string &code)
+
+/**
+ * The grammars are built only once, since that takes long and reassigns shared static rules.
+ * Parsing doesn't modify them, so they can be used on several threads at once, each with its
+ * own global scope (see @ref GlobalScopeGuard).
+ */
+struct Grammars {
+	ProgramParser program;
+	ModuleParser module;
+};
+
+const Grammars &grammars()
 {
-	Expression *rv = nullptr;
-	ProgramParser program_parser;
+	static const Grammars rv;
+	return rv;
+}
+
+
+/**
+ * @brief A private, writable memory mapping of a source file, so that it can be parsed without copying it.
+ * Writes (see @ref strip_comments) only copy the pages they touch and never reach the file.
+ */
+class MappedFile {
+public:
+	MappedFile(const string &filename)
+	{
+		int fd = ::open(filename.c_str(), O_RDONLY);
+		if (fd < 0)
+			throw std::runtime_error(filename + ": " + ::strerror(errno));
+
+		struct stat st;
+		if (::fstat(fd, &st)) {
+			int err = errno;
+			::close(fd);
+			throw std::runtime_error(filename + ": " + ::strerror(err));
+		}
+		size_ = size_t(st.st_size);
 
+		// An empty mapping isn't possible, but also not needed
+		if (size_ > 0) {
+			void *addr = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+			if (addr == MAP_FAILED) {
+				int err = errno;
+				::close(fd);
+				throw std::runtime_error(filename + ": " + ::strerror(err));
+			}
+			data_ = static_cast<char *>(addr);
+		}
+		::close(fd);
+	}
 
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator = (const MappedFile &) = delete;
+
+	~MappedFile()
+	{
+		if (data_)
+			::munmap(data_, size_);
+	}
+
+	char *begin()
+	{ return data_; }
+
+	char *end()
+	{ return data_ + size_; }
+
+private:
+	char *data_ = nullptr;
+	size_t size_ = 0;
+};
+
+
+/// @return The canonical path of @param name imported from @param importing_file.
+string resolve_import(const string &importing_file, const string &name)
+{
+	string path = name;
+	string::size_type dir_end = importing_file.rfind('/');
+	if (name.empty() || (name[0] != '/' && dir_end != string::npos))
+		path = importing_file.substr(0, dir_end + 1) + name;
+
+	char resolved[PATH_MAX];
+	if (!::realpath(path.c_str(), resolved))
+		throw std::runtime_error(path + ": " + ::strerror(errno));
+	return resolved;
+}
+
+
+vector<string> scan_imports(iterator begin, iterator end)
+{
+	vector<string> rv;
 	boost::spirit::qi::phrase_parse(
-		iterator(code.cbegin()),
-		iterator(code.cend()),
-		program_parser(boost::phoenix::ref(global_scope())),
+		begin,
+		end,
+		*import_directive(),
 		gologpp_skipper(),
 		rv
 	);
+	return rv;
+}
+
+
+
+struct Module {
+	unique_ptr<MappedFile> source;
+	vector<string> imports;
+	size_t level = 0;
+	unique_ptr<Scope> scope;
+	Scope *merged_scope = nullptr;
+	std::exception_ptr error;
+};
+
+// Sorted by path, which fixes the order in which errors are reported and modules are merged
+using ModuleMap = std::map<string, Module>;
 
 
+/// Load @param path and everything it imports, and compute its level: One more than the highest level it imports.
+size_t load_module(ModuleMap &modules, vector<string> &import_stack, const string &path)
+{
+	if (std::find(import_stack.begin(), import_stack.end(), path) != import_stack.end()) {
+		string cycle;
+		for (auto it = std::find(import_stack.begin(), import_stack.end(), path); it != import_stack.end(); ++it)
+			cycle += *it + " -> ";
+		throw UserError("Import cycle: " + cycle + path);
+	}
+
+	auto it = modules.find(path);
+	if (it != modules.end())
+		return it->second.level;
+
+	Module module;
+	module.source.reset(new MappedFile(path));
+	strip_comments(module.source->begin(), module.source->end());
+	import_stack.push_back(path);
+	for (const string &name : scan_imports(module.source->begin(), module.source->end())) {
+		string import_path = resolve_import(path, name);
+		module.level = std::max(module.level, load_module(modules, import_stack, import_path) + 1);
+		module.imports.push_back(import_path);
+	}
+	import_stack.pop_back();
+
+	size_t level = module.level;
+	modules.emplace(path, std::move(module));
+	return level;
+}
+
+
+void parse_module(Module &module)
+{
+	try {
+		GlobalScopeGuard guard(*module.scope);
+		boost::spirit::qi::phrase_parse(
+			iterator(module.source->begin()),
+			iterator(module.source->end()),
+			grammars().module(boost::phoenix::ref(*module.scope)),
+			gologpp_skipper()
+		);
+	} catch (...) {
+		module.error = std::current_exception();
+	}
+}
+
+
+void parse_level(vector<Module *> &level, unsigned int threads)
+{
+	std::atomic<size_t> next { 0 };
+	auto worker = [&] {
+		for (size_t i = next++; i < level.size(); i = next++)
+			parse_module(*level[i]);
+	};
+
+	vector<std::thread> workers;
+	for (unsigned int i = 1; i < std::min<size_t>(threads, level.size()); ++i)
+		workers.emplace_back(worker);
+	worker();
+	for (std::thread &t : workers)
+		t.join();
+}
+
+
+unique_ptr<Expression> parse_program(iterator begin, iterator end)
+{
+	Expression *rv = nullptr;
+
+	boost::spirit::qi::phrase_parse(
+		begin,
+		end,
+		grammars().program(boost::phoenix::ref(global_scope())),
+		gologpp_skipper(),
+		rv
+	);
+
 	return unique_ptr<Expression>(rv);
 }
 
 
+/// @return The representation of the field [@param begin, @param end) as a value of @param type.
+Value::Representation initial_value_field(const Type &type, const char *begin, const char *end)
+{
+	while (begin < end && (*begin == ' ' || *begin == '\t'))
+		++begin;
+	while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r'))
+		--end;
+	string field(begin, end);
+
+	switch (type.kind()) {
+	case Type::Kind::BOOL:
+		if (field == "true")
+			return true;
+		if (field == "false")
+			return false;
+		break;
+	case Type::Kind::NUMBER:
+		if (!field.empty()) {
+			char *parsed;
+			errno = 0;
+			long l = std::strtol(field.c_str(), &parsed, 10);
+			if (!*parsed && !errno) {
+				if (l >= INT_MIN && l <= INT_MAX)
+					return int(l);
+				return l;
+			}
+			double d = std::strtod(field.c_str(), &parsed);
+			if (!*parsed)
+				return d;
+		}
+		break;
+	case Type::Kind::STRING:
+		if (field.size() >= 2 && field.front() == '"' && field.back() == '"')
+			return field.substr(1, field.size() - 2);
+		return field;
+	case Type::Kind::SYMBOL:
+		if (!field.empty())
+			return field;
+		break;
+	default:
+		throw UserError("Cannot load initial values of type " + type.name());
+	}
+	throw UserError("Invalid " + type.name() + " value: \"" + field + "\"");
+}
+
+
+} // namespace
+
+
+
+unique_ptr<Expression> parse_string(const std::string &code)
+{
+	const string stripped = strip_comments(code);
+	return parse_program(stripped.data(), stripped.data() + stripped.size());
+}
+
+
+vector<shared_ptr<Global>> parse_definitions(const std::string &code)
+{
+	vector<Global *> globals;
+	const string stripped = strip_comments(code);
+
+	boost::spirit::qi::phrase_parse(
+		stripped.data(),
+		stripped.data() + stripped.size(),
+		grammars().module(boost::phoenix::ref(global_scope())),
+		gologpp_skipper(),
+		globals
+	);
+
+	vector<shared_ptr<Global>> rv;
+	for (Global *g : globals)
+		rv.push_back(g->shared_from_this());
+	return rv;
+}
+
+
+void load_initial_values(Fluent &fluent, const std::string &filename)
+{
+	MappedFile source(filename);
+	const char *begin = source.begin();
+	const char *end = source.end();
+
+	// Resolve the column types once
+	vector<const Type *> columns;
+	for (const shared_ptr<Variable> &param : fluent.params())
+		columns.push_back(&param->type());
+	columns.push_back(&fluent.type());
+
+	const size_t lines = size_t(std::count(begin, end, '\n')) + 1;
+	vector<Value::Representation> args, values;
+	args.reserve(lines * fluent.arity());
+	values.reserve(lines);
+
+	size_t line = 0;
+	for (const char *l_start = begin; l_start < end; ) {
+		const char *l_end = std::find(l_start, end, '\n');
+		++line;
+
+		const char *first = l_start;
+		while (first < l_end && std::isspace(static_cast<unsigned char>(*first)))
+			++first;
+		if (first < l_end && *first != '#') {
+			try {
+				size_t column = 0;
+				for (const char *f_start = l_start; f_start <= l_end; ++column) {
+					const char *f_end = f_start;
+					// Commas in quoted strings don't separate fields
+					for (bool quoted = false; f_end < l_end && (quoted || *f_end != ','); ++f_end)
+						if (*f_end == '"')
+							quoted = !quoted;
+					if (column >= columns.size())
+						throw UserError("More than " + std::to_string(columns.size())
+							+ " columns for fluent " + fluent.signature_str());
+					Value::Representation field = initial_value_field(*columns[column], f_start, f_end);
+					if (column < fluent.arity())
+						args.push_back(std::move(field));
+					else
+						values.push_back(std::move(field));
+					f_start = f_end + 1;
+				}
+				if (column < columns.size())
+					throw UserError("Less than " + std::to_string(columns.size())
+						+ " columns for fluent " + fluent.signature_str());
+			} catch (UserError &e) {
+				throw UserError(filename + ":" + std::to_string(line) + ": " + e.what());
+			}
+		}
+		l_start = l_end == end ? end : l_end + 1;
+	}
+
+	fluent.define(std::move(args), std::move(values));
+}
+
+
 unique_ptr<Expression> parse_file(const std::string &filename)
+{ return parse_file(filename, std::max(1u, std::thread::hardware_concurrency())); }
+
+
+unique_ptr<Expression> parse_file(const std::string &filename, unsigned int threads)
 {
-	std::ifstream file(filename);
-	if (!file.is_open())
-		throw std::runtime_error(filename + ": " + ::strerror(errno));
-	std::stringstream buffer;
-	buffer << file.rdbuf();
-	if (!file.good())
-		throw std::runtime_error(filename + ": " + ::strerror(errno));
+	MappedFile source(filename);
 
 	std::cout << "Parsing " << filename << "..." << std::endl;
 	auto t1 = std::chrono::high_resolution_clock::now();
 
-	unique_ptr<Expression> rv = parse_string(buffer.str());
+	ModuleMap modules;
+	vector<vector<Module *>> levels;
+	{
+		vector<string> import_stack { resolve_import("", filename) };
+		strip_comments(source.begin(), source.end());
+		for (const string &name : scan_imports(source.begin(), source.end()))
+			load_module(modules, import_stack, resolve_import(filename, name));
+	}
+	for (ModuleMap::value_type &entry : modules) {
+		if (levels.size() <= entry.second.level)
+			levels.resize(entry.second.level + 1);
+		levels[entry.second.level].push_back(&entry.second);
+	}
+
+	if (!modules.empty()) {
+		// Every module starts out with what was declared before, plus what it imports
+		unique_ptr<Scope> base = global_scope().make_module_scope();
+
+		for (vector<Module *> &level : levels) {
+			for (Module *module : level) {
+				vector<const Scope *> imports;
+				for (const string &import : module->imports)
+					imports.push_back(modules.at(import).merged_scope);
+				module->scope = base->make_module_scope(imports);
+			}
+
+			parse_level(level, threads);
+
+			for (Module *module : level)
+				if (module->error)
+					std::rethrow_exception(module->error);
+			for (Module *module : level) {
+				module->merged_scope = module->scope.get();
+				global_scope().merge(std::move(module->scope));
+				module->source.reset();
+			}
+		}
+	}
+
+	unique_ptr<Expression> rv = parse_program(source.begin(), source.end());
 	std::chrono::duration<double> td = std::chrono::high_resolution_clock::now() - t1;
 
 	std::cout << "... done. Parsing took " << td.count() << " s." << std::endl;
@@ -7,10 +7,41 @@ namespace gologpp {
 namespace parser {
 
 
+/// Parse into the current global scope. Import directives are ignored, see @ref parse_file.
 unique_ptr<Expression> parse_string(const std::string &code);
 
 unique_ptr<Expression> parse_file(const std::string &filename);
 
+/**
+ * @brief Parse @param filename and all files it imports with `import "other.gpp"`.
+ * Imported files may only contain declarations. Relative paths are resolved against the importing file.
+ * Files that don't import each other are parsed concurrently on up to @param threads threads, each
+ * into its own module scope, and merged into the global scope in a fixed order afterwards.
+ * Must not run concurrently with other parsing into the same global scope.
+ * @throw UserError on an import cycle
+ * @throw RedefinitionError if two modules declare the same thing
+ */
+unique_ptr<Expression> parse_file(const std::string &filename, unsigned int threads);
+
+/**
+ * @brief Parse declarations without a program into the current global scope, like an imported file.
+ * A definition of a global that already exists replaces the previous one in place, so that
+ * references to it stay valid. Pass the result to @ref AExecutionContext::redefine to recompile it.
+ * @return The globals that were declared or defined.
+ */
+vector<shared_ptr<Global>> parse_definitions(const std::string &code);
+
+/**
+ * @brief Define @param fluent from the comma-separated file @param filename, e.g. a large initial state
+ * exported from a database. Each line holds one initial value: A column for each of the fluent's arguments,
+ * followed by a column for the value. Empty lines and lines that start with `#' are skipped.
+ * Fields are read as the types in the fluent's signature, i.e. numbers, `true'/`false', strings
+ * (optionally in double quotes) or symbols. All initial values are added in one go, see @ref Fluent::define.
+ * @throw UserError on malformed lines and unsupported types
+ */
+void load_initial_values(Fluent &fluent, const std::string &filename);
+
+
 
 } // namespace parser
 } // namespace gologpp
@@ -17,6 +17,7 @@
 #include <boost/spirit/include/qi_char_.hpp>
 
 #include <iostream>
+#include <algorithm>
 
 namespace gologpp {
 namespace parser {
@@ -44,51 +45,82 @@ rule<string()> &raw_string_literal() {
 }
 
 
+rule<string()> &import_directive() {
+	static rule<string()> rv {
+		qi::lexeme [ lit("import") >> !(qi::alnum | char_('_')) ]
+		> raw_string_literal()
+		, "import_directive"
+	};
+	return rv;
+}
 
 
-gologpp_skipper::gologpp_skipper()
-: gologpp_skipper::base_type(skip, "skipper")
-{
-	skip = spc | comment_oneline | comment_multiline;
 
-	spc = space;
-	spc.name("space");
 
-	comment_multiline = omit [
-		lit("/*") > *((!lit("*/")) > (char_ | eol)) > "*/"
-	];
-	comment_multiline.name("comment_multiline");
+string strip_comments(const string &code)
+{
+	string rv(code);
+	strip_comments(&rv[0], &rv[0] + rv.size());
+	return rv;
+}
+
 
-	comment_oneline = omit [
-		lit("//") > *(char_ - eol)
-	];
-	comment_oneline.name("comment_oneline");
+void strip_comments(char *begin, char *end)
+{
+	static const char comment_end[] = "*/";
+	char *i = begin;
+	while (i < end) {
+		if (*i == '"') {
+			// String literals have no escapes, see raw_string_literal()
+			i = std::find(i + 1, end, '"');
+			if (i == end)
+				break;
+			++i;
+		}
+		else if (*i == '/' && i + 1 < end && i[1] == '/') {
+			for (; i < end && *i != '\n' && *i != '\r'; ++i)
+				*i = ' ';
+		}
+		else if (*i == '/' && i + 1 < end && i[1] == '*') {
+			char *c_end = std::search(i + 2, end, comment_end, comment_end + 2);
+			if (c_end == end)
+				break;
+			for (c_end += 2; i < c_end; ++i)
+				if (*i != '\n' && *i != '\r')
+					*i = ' ';
+		}
+		else
+			++i;
+	}
 }
 
 
 
 void handle_error(const iterator &begin, const iterator &errpos, const iterator &end, const boost::spirit::info &expected) {
-	iterator::base_type l_start;
+	iterator l_start;
 	string mark;
 	for (
-		l_start = errpos.base() - 1;
-		*l_start != '\n' && *l_start != '\r' && l_start >= begin.base();
+		l_start = errpos;
+		l_start > begin && l_start[-1] != '\n' && l_start[-1] != '\r';
 		--l_start
 	) {
-		if (*l_start == '\t')
+		if (l_start[-1] == '\t')
 			mark = '\t' + mark;
 		else
 			mark = " " + mark;
 	}
 	mark += '^';
 
-	iterator::base_type l_end = errpos.base();
-	while (l_end < end.base() && *l_end != '\n' && *l_end != '\r')
+	iterator l_end = errpos;
+	while (l_end < end && *l_end != '\n' && *l_end != '\r')
 		++l_end;
 
 	string line(l_start, l_end);
 
-	std::cout << "Syntax error at line " << get_line(errpos) << ":" << std::endl
+	// Counted only here, so that parsing doesn't have to keep track of line numbers
+	long line_number = std::count(begin, errpos, '\n') + 1;
+
+	std::cout << "Syntax error at line " << line_number << ":" << std::endl
 		<< line << std::endl
 		<< mark << std::endl
 		<< "Expected: " << expected << std::endl;
@@ -3,10 +3,11 @@
 
 #include <model/expressions.h>
 
-#include <boost/spirit/include/support_line_pos_iterator.hpp>
 #include <boost/spirit/include/qi_nonterminal.hpp>
+#include <boost/spirit/include/qi_char_class.hpp>
 
 #include <boost/preprocessor/seq/for_each.hpp>
+#include <boost/phoenix/statement/sequence.hpp>
 
 
 namespace gologpp {
@@ -42,18 +43,24 @@ using fusion_wtf_vector = boost::fusion::vector2<T1, T2>;
 #endif
 
 
-using iterator = boost::spirit::line_pos_iterator<string::const_iterator>;
+/// Plain pointers into the source, which is parsed in place. Line numbers are only counted
+/// when an error is reported, see @ref handle_error.
+using iterator = const char *;
 
 
 
-struct gologpp_skipper : public qi::grammar<iterator> {
-	gologpp_skipper();
-	
-	qi::rule<iterator> skip;
-	qi::rule<iterator> spc;
-	qi::rule<iterator> comment_multiline;
-	qi::rule<iterator> comment_oneline;
-};
+/// Comments are removed by @ref strip_comments before parsing, so only whitespace is left to skip.
+using gologpp_skipper = boost::spirit::standard::space_type;
+
+/**
+ * @brief Replace all comments in @param code by blanks in a single pass.
+ * Line breaks are kept, so positions in error messages stay the same.
+ * An unterminated multi-line comment is left alone for the parser to report.
+ */
+string strip_comments(const string &code);
+
+/// Like @ref strip_comments, but in place on the characters from @param begin to @param end.
+void strip_comments(char *begin, char *end);
 
 
 template<typename... SignatureTs>
@@ -68,6 +75,9 @@ rule<string()> &r_name();
 
 rule<string()> &raw_string_literal();
 
+/// `import "file.gpp"`: The attribute is the file name, relative to the importing file.
+rule<string()> &import_directive();
+
 
 void handle_error(
 	const iterator &begin,
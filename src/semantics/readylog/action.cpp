@@ -161,9 +161,25 @@ EC_word Semantics<Activity>::plterm()
 
 EC_word Semantics<Activity>::sensing_result()
 {
+	const SensingResult &sr = activity().sensing_result();
+	EC_word value;
+
+	if (sr.is_numeric_array()) {
+		// Build the gpp_list term directly, without going through a Value tree
+		EC_word list = ::nil();
+		for (auto it = sr.numbers().rbegin(); it != sr.numbers().rend(); ++it)
+			list = ::list(EC_word(*it), list);
+		value = ::term(EC_functor("gpp_list", 2),
+			EC_atom(("#" + NumberType::name()).c_str()),
+			list
+		);
+	}
+	else
+		value = sr.value()->semantics().plterm();
+
 	return ::term(EC_functor("e", 2),
 		activity().target()->senses()->semantics().plterm(),
-		activity().sensing_result()->semantics().plterm()
+		value
 	);
 }
 
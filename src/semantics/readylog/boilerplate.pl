@@ -1,6 +1,7 @@
 :- external(exog_fluent_getValue/3, p_exog_fluent_getValue).
 :- dynamic managed_term/2.
 :- dynamic durative_action/1, durative_poss/2, durative_causes_val/4.
+:- dynamic proc/2, function/3, exog_action/1, poss/2, causes_val/4, senses/2.
 :- lib(listut).
 
 % resolve name clash with lib(listut)
@@ -9,6 +9,7 @@
 #include "history.h"
 
 #include <model/action.h>
+#include <model/logger.h>
 
 
 namespace gologpp {
@@ -29,7 +30,7 @@ ReadylogContext::ReadylogContext(const eclipse_opts &options, unique_ptr<Platfor
 , options_(options)
 {
 	ec_set_option_ptr(EC_OPTION_ECLIPSEDIR, const_cast<void *>(static_cast<const void *>(ECLIPSE_DIR)));
-	std::cout << "Using eclipse-clp in " << ECLIPSE_DIR << std::endl;
+	log(LogLevel::INF, [] (std::ostream &s) { s << "Using eclipse-clp in " << ECLIPSE_DIR; });
 
 	int rv;
 	if ((rv = ec_init()))
@@ -37,7 +38,7 @@ ReadylogContext::ReadylogContext(const eclipse_opts &options, unique_ptr<Platfor
 
 	ec_start_ = new EC_ref();
 
-	std::cout << "Loading readylog from " << READYLOG_PATH " ..." << std::endl;
+	log(LogLevel::INF, [] (std::ostream &s) { s << "Loading readylog from " << READYLOG_PATH " ..."; });
 
 	if (options.trace)
 		post_goal("set_flag(debug_compile, on)");
@@ -47,12 +48,12 @@ ReadylogContext::ReadylogContext(const eclipse_opts &options, unique_ptr<Platfor
 	post_goal(::term(EC_functor("compile", 1), EC_atom(READYLOG_PATH)));
 
 	if ((last_rv_ = EC_resume(*ec_start_)) == EC_status::EC_succeed)
-		std::cout << "... done." << std::endl;
+		log(LogLevel::INF, [] (std::ostream &s) { s << "... done."; });
 	else
 		throw std::runtime_error("Error " + std::to_string(rv) + " loading readylog interpreter");
 
 	if (options.trace) {
-		std::cout << "Enabling ECLiPSe debugging." << std::endl;
+		log(LogLevel::INF, [] (std::ostream &s) { s << "Enabling ECLiPSe debugging."; });
 		if (options.guitrace) {
 			post_goal("lib(remote_tools)");
 			post_goal("attach_tools");
@@ -97,6 +98,8 @@ void ReadylogContext::compile(const AbstractAction &aa)
 	try {
 		const Action &action = dynamic_cast<const Action &>(aa);
 		Semantics<Action> &action_impl = action.semantics();
+		actions_by_functor_[EC_functor(action.name().c_str(), action.arity()).d] =
+			std::dynamic_pointer_cast<Action>(std::const_pointer_cast<Global>(action.shared_from_this()));
 		compile_term(action_impl.durative_action());
 		compile_term(action_impl.durative_poss());
 		for (EC_word causes_val : action_impl.durative_causes_vals())
@@ -119,8 +122,7 @@ void ReadylogContext::compile(const AbstractAction &aa)
 void ReadylogContext::compile(const Fluent &fluent)
 {
 	compile_term(fluent.semantics<Fluent>().prim_fluent());
-	for (EC_word &initially : fluent.semantics<Fluent>().initially())
-		compile_term(initially);
+	compile_term(fluent.semantics<Fluent>().initially());
 }
 
 
@@ -138,6 +140,50 @@ void ReadylogContext::compile_term(const EC_word &term)
 }
 
 
+void ReadylogContext::retract(const Global &global)
+{
+	// The head of all clauses that refer to global, with its arguments left open
+	EC_word head;
+	if (global.arity() > 0) {
+		vector<EC_word> args;
+		for (arity_t i = 0; i < global.arity(); ++i)
+			args.push_back(::newvar());
+		head = ::term(EC_functor(global.name().c_str(), global.arity()), args.data());
+	}
+	else
+		head = EC_atom(global.name().c_str());
+
+	if (dynamic_cast<const Function *>(&global)) {
+		retract_all("proc", head, 1);
+		retract_all("function", head, 2);
+	}
+	else if (dynamic_cast<const Action *>(&global)) {
+		actions_by_functor_.erase(EC_functor(global.name().c_str(), global.arity()).d);
+		retract_all("durative_action", head, 0);
+		retract_all("durative_poss", head, 1);
+		retract_all("durative_causes_val", head, 3);
+		retract_all("senses", head, 1);
+	}
+	else if (dynamic_cast<const ExogAction *>(&global)) {
+		retract_all("exog_action", head, 0);
+		retract_all("poss", head, 1);
+		retract_all("causes_val", head, 3);
+	}
+}
+
+
+void ReadylogContext::retract_all(const char *functor, EC_word head, int extra_args)
+{
+	vector<EC_word> args { head };
+	for (int i = 0; i < extra_args; ++i)
+		args.push_back(::newvar());
+	if (!ec_query(::term(EC_functor("retract_all", 1),
+		::term(EC_functor(functor, static_cast<int>(args.size())), args.data())
+	)))
+		throw EclipseError(string("Failed to retract_all/1 for ") + functor);
+}
+
+
 void ReadylogContext::postcompile()
 {
 	if (!ec_query(EC_atom("compile_SSAs")))
@@ -146,7 +192,10 @@ void ReadylogContext::postcompile()
 
 
 void ReadylogContext::ec_write(EC_word t)
-{ ec_query(::term(EC_functor("printf", 2), "%Qw%n", ::list(t, ::nil()))); }
+{
+	// Only ask ECLiPSe to format the term if anyone is going to see it
+	log(LogLevel::DBG, [&] (std::ostream &s) { s << to_string(t); });
+}
 
 
 string ReadylogContext::to_string(EC_word t)
@@ -163,6 +212,15 @@ string ReadylogContext::to_string(EC_word t)
 }
 
 
+shared_ptr<Action> ReadylogContext::action(dident functor) const
+{
+	auto it = actions_by_functor_.find(functor);
+	if (it == actions_by_functor_.end())
+		return nullptr;
+	return it->second;
+}
+
+
 void ReadylogContext::ec_cut()
 {
 	EC_resume();
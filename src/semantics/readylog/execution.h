@@ -2,6 +2,7 @@
 #define READYLOG_EXECUTION_H_
 
 #include <iostream>
+#include <unordered_map>
 
 #include <model/execution.h>
 
@@ -41,14 +42,24 @@ public:
 	void ec_write(EC_word t);
 	string to_string(EC_word t);
 
+	/// @return The action whose ReadyLog terms have the functor @param functor, or nullptr.
+	shared_ptr<Action> action(dident functor) const;
+
 private:
     ReadylogContext(const eclipse_opts &options, unique_ptr<PlatformBackend> &&exec_backend);
 
     virtual void compile_term(const EC_word &term);
 
+	/// Retract all clauses of the dynamic procedures that hold the definition of @param global.
+	virtual void retract(const Global &global) override;
+
+	/// Retract the clauses whose head is @param functor applied to @param head and @param extra_args more variables.
+	void retract_all(const char *functor, EC_word head, int extra_args);
+
 	EC_ref *ec_start_;
 	int last_rv_;
 	eclipse_opts options_;
+	std::unordered_map<dident, shared_ptr<Action>> actions_by_functor_;
 	static unique_ptr<ReadylogContext> instance_;
 };
 
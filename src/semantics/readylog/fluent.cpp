@@ -85,11 +85,12 @@ EC_word Semantics<Fluent>::plterm()
 }
 
 
-vector<EC_word> Semantics<Fluent>::initially()
+EC_word Semantics<Fluent>::initially()
 {
-	vector<EC_word> rv;
-	for (const unique_ptr<InitialValue> &ival : fluent_.initially())
-		rv.push_back(ival->semantics().plterm());
+	// Built back to front, since to_ec_list would recurse once per initial value
+	EC_word rv = ::nil();
+	for (auto it = fluent_.initially().rbegin(); it != fluent_.initially().rend(); ++it)
+		rv = ::list((*it)->semantics().plterm(), rv);
 
 	return rv;
 }
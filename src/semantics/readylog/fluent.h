@@ -31,7 +31,10 @@ public:
 	virtual ~Semantics() override = default;
 
 	virtual EC_word plterm() override;
-	vector<EC_word> initially();
+
+	/// @return All initial_val/2 clauses of the fluent in one list, so that they can be compiled at once.
+	EC_word initially();
+
 	EC_word prim_fluent();
 
 private:
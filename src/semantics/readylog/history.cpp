@@ -27,109 +27,114 @@ EC_word Semantics<History>::get_history_head()
 }
 
 
-string Semantics<History>::get_head_name(EC_word head)
+dident Semantics<History>::get_head_functor(EC_word head)
 {
 	EC_functor headfunctor;
 	EC_atom head_atom;
 	if (head.functor(&headfunctor) == EC_succeed)
-		return headfunctor.name();
+		return headfunctor.d;
 	else if (head.is_atom(&head_atom) == EC_succeed)
-		return head_atom.name();
+		// An atom's dident is the same as that of the functor with arity 0
+		return head_atom.d;
 
 	throw Bug("Unknown term in history");
 }
 
 
-Value *pl_term_to_value(EC_word term) {
-	EC_word type, list, list_head, list_tail;
+/// Decode @param term as a value of the expected @param type. @return nullptr if it doesn't match.
+Value *pl_term_to_value(EC_word term, const Type &type) {
+	static const EC_atom true_atom("true");
+	static const EC_atom fail_atom("fail");
+	static const EC_functor list_functor("gpp_list", 2);
+	static const EC_functor compound_functor("gpp_compound", 2);
+
+	EC_word list, list_head, list_tail;
 	EC_atom did;
 	EC_functor ftor;
 	double d;
 	long i;
 	char *s;
 
-	if (EC_succeed == term.is_long(&i))
-		return new Value(NumberType::name(), i);
-	else if (EC_succeed == term.is_double(&d))
-		return new Value(NumberType::name(), d);
-	else if (EC_succeed == term.is_atom(&did)) {
-		if (did == EC_atom("true"))
-			return new Value(BoolType::name(), true);
-		else if (did == EC_atom("fail"))
-			return new Value(BoolType::name(), false);
-		else
-			return new Value(SymbolType::name(), string(did.name()));
+	if (type.is<NumberType>()) {
+		if (EC_succeed == term.is_long(&i))
+			return new Value(type, i);
+		else if (EC_succeed == term.is_double(&d))
+			return new Value(type, d);
+	}
+	else if (type.is<BoolType>()) {
+		if (EC_succeed == term.is_atom(&did)) {
+			if (did.d == true_atom.d)
+				return new Value(type, true);
+			else if (did.d == fail_atom.d)
+				return new Value(type, false);
+		}
 	}
-	else if (EC_succeed == term.is_string(&s))
-		return new Value(StringType::name(), string(s));
-	else if (
-		term.functor(&ftor) == EC_succeed
-		&& ftor.name() == string("gpp_list")
-		&& ftor.arity() == 2
-		&& term.arg(1, type) == EC_succeed
-		&& type.is_atom(&did) == EC_succeed
-		&& term.arg(2, list) == EC_succeed
-		&& list.is_list(list_head, list_tail) == EC_succeed
-	) {
-		vector<Value *> list_repr;
-		do {
-			list_repr.push_back(pl_term_to_value(list_head));
-		} while (EC_succeed == list_tail.is_list(list_head, list_tail));
-
-		string elem_t(did.name());
-		elem_t = elem_t.substr(1); // remove # prefix that is added to avoid name clashes
-
-		return new Value {
-			"list[" + elem_t + "]",
-			boost::optional<vector<Value *>> { list_repr }
-		};
+	else if (type.is<SymbolType>()) {
+		if (EC_succeed == term.is_atom(&did))
+			return new Value(type, string(did.name()));
 	}
-	else if (
-		term.functor(&ftor) == EC_succeed
-		&& ftor.name() == string("gpp_compound")
-		&& ftor.arity() == 2
-		&& term.arg(1, type) == EC_succeed
-		&& type.is_atom(&did) == EC_succeed
-		&& term.arg(2, list) == EC_succeed
-		&& list.is_list(list_head, list_tail) == EC_succeed
-	) {
-		vector<fusion_wtf_vector<string, Value *>> compound_repr;
-		do {
-			EC_functor field_ftor;
-			EC_word field_value;
-			if (
-				list_head.functor(&field_ftor) == EC_succeed
-				&& field_ftor.arity() == 1
-				&& list_head.arg(0, field_value)
-			) {
-				compound_repr.push_back(
-					fusion_wtf_vector<string, Value *> {
-						string(field_ftor.name()), pl_term_to_value(list_head)
-					}
-				);
+	else if (type.is<StringType>()) {
+		if (EC_succeed == term.is_string(&s))
+			return new Value(type, string(s));
+	}
+	else if (type.is<ListType>()) {
+		if (
+			term.functor(&ftor) == EC_succeed
+			&& ftor.d == list_functor.d
+			&& term.arg(2, list) == EC_succeed
+		) {
+			const Type &elem_type = dynamic_cast<const ListType &>(type).element_type();
+			vector<shared_ptr<Value>> list_repr;
+			while (EC_succeed == list.is_list(list_head, list_tail)) {
+				Value *elem = pl_term_to_value(list_head, elem_type);
+				if (!elem)
+					return nullptr;
+				list_repr.emplace_back(elem);
+				list = list_tail;
 			}
-			else
-				return nullptr;
-		} while (EC_succeed == list_tail.is_list(list_head, list_tail));
-
-		string type_name(did.name());
-		type_name = type_name.substr(1); // remove # prefix that is added to avoid name clashes
-
-		return new Value(type_name, compound_repr);
+			return new Value(type, ListType::Representation(std::move(list_repr)));
+		}
+	}
+	else if (type.is_compound()) {
+		if (
+			term.functor(&ftor) == EC_succeed
+			&& ftor.d == compound_functor.d
+			&& term.arg(2, list) == EC_succeed
+		) {
+			const CompoundType &compound_type = dynamic_cast<const CompoundType &>(type);
+			std::unordered_map<string, shared_ptr<Value>> compound_repr;
+			while (EC_succeed == list.is_list(list_head, list_tail)) {
+				EC_functor field_ftor;
+				EC_word field_value;
+				if (
+					list_head.functor(&field_ftor) != EC_succeed
+					|| field_ftor.arity() != 1
+					|| list_head.arg(1, field_value) != EC_succeed
+				)
+					return nullptr;
+
+				string field_name(field_ftor.name());
+				Value *v = pl_term_to_value(field_value, compound_type.field_type(field_name));
+				if (!v)
+					return nullptr;
+				compound_repr[field_name].reset(v);
+				list = list_tail;
+			}
+			return new Value(type, CompoundType::Representation(std::move(compound_repr)));
+		}
 	}
 
-	else
-		return nullptr;
+	return nullptr;
 }
 
 
-vector<unique_ptr<Value>> get_args(EC_word head) {
+vector<unique_ptr<Value>> get_args(EC_word head, const Action &action) {
 	EC_word term;
 	vector<unique_ptr<Value>> rv;
 
 	for (int j = 1; j <= head.arity(); j++) {
 		head.arg(j,term);
-		Value *v = pl_term_to_value(term);
+		Value *v = pl_term_to_value(term, action.params()[size_t(j - 1)]->type());
 
 		if (!v)
 			throw Bug("Invalid argument #" + std::to_string(j) + " in expression " + ReadylogContext::instance().to_string(head));
@@ -141,12 +146,17 @@ vector<unique_ptr<Value>> get_args(EC_word head) {
 }
 
 
-static const std::unordered_map<string, Transition::Hook> name2state {
-	{ "start", Transition::Hook::START },
-	{ "stop", Transition::Hook::STOP },
-	{ "finish", Transition::Hook::FINISH },
-	{ "fail", Transition::Hook::FAIL },
-};
+/// Keyed by the dident of the ReadyLog functor, so it can only be built once ECLiPSe is running.
+static const std::unordered_map<dident, Transition::Hook> &transition_hooks()
+{
+	static const std::unordered_map<dident, Transition::Hook> hooks {
+		{ EC_functor("start", 2).d, Transition::Hook::START },
+		{ EC_functor("stop", 2).d, Transition::Hook::STOP },
+		{ EC_functor("finish", 2).d, Transition::Hook::FINISH },
+		{ EC_functor("fail", 2).d, Transition::Hook::FAIL },
+	};
+	return hooks;
+}
 
 
 shared_ptr<Transition> Semantics<History>::get_last_transition()
@@ -155,24 +165,20 @@ shared_ptr<Transition> Semantics<History>::get_last_transition()
 		return nullptr;
 
 	EC_word head = get_history_head();
-	string headname = get_head_name(head);
+	auto state_it = transition_hooks().find(get_head_functor(head));
 
-	auto state_it = name2state.find(headname);
-
-	if (state_it == name2state.end())
+	if (state_it == transition_hooks().end())
 		return nullptr;
 
-	if (head.arity() != 2)
-		throw EngineError("Transition arity must be 2: " + headname);
-
 	head.arg(1, head);
-	headname = get_head_name(head);
 
-	vector<unique_ptr<Value>> args = get_args(head);
-	shared_ptr<Action> action = global_scope().lookup_global<Action>(headname, arity_t(head.arity()));
-	shared_ptr<Transition> rv;
+	shared_ptr<Action> action = ReadylogContext::instance().action(get_head_functor(head));
+	if (!action)
+		throw Bug("No action for transition " + ReadylogContext::instance().to_string(head));
+
+	vector<unique_ptr<Value>> args = get_args(head, *action);
 
-	return std::make_shared<Transition>(action, std::move(args), state_it->second);
+	return make_pooled<Transition>(action, std::move(args), state_it->second);
 }
 
 
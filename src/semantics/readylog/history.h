@@ -23,7 +23,7 @@ public:
 	bool has_changed() const;
 
 private:
-	string get_head_name(EC_word head);
+	dident get_head_functor(EC_word head);
 	EC_word get_history_head();
 
 	ManagedTerm readylog_history_;
@@ -0,0 +1,303 @@
+#include "pool.h"
+
+#include <model/procedural.h>
+#include <model/logger.h>
+#include <parser/parser.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace gologpp {
+
+
+namespace {
+
+
+/*
+ * Messages are a uint32 size followed by that many bytes. A request is one message with the
+ * program source, a result is three messages: "1" or "0" for success, then the history or the
+ * error message, then the metrics.
+ */
+
+bool send_all(int fd, const char *data, size_t size)
+{
+	while (size) {
+		ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		data += n;
+		size -= size_t(n);
+	}
+	return true;
+}
+
+bool recv_all(int fd, char *data, size_t size)
+{
+	while (size) {
+		ssize_t n = ::recv(fd, data, size, 0);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		data += n;
+		size -= size_t(n);
+	}
+	return true;
+}
+
+bool send_message(int fd, const string &msg)
+{
+	uint32_t size = uint32_t(msg.size());
+	return send_all(fd, reinterpret_cast<const char *>(&size), sizeof(size))
+		&& send_all(fd, msg.data(), msg.size());
+}
+
+bool recv_message(int fd, string &msg)
+{
+	uint32_t size;
+	if (!recv_all(fd, reinterpret_cast<char *>(&size), sizeof(size)))
+		return false;
+	msg.resize(size);
+	return recv_all(fd, &msg[0], size);
+}
+
+bool send_result(int fd, const ReadylogPool::Result &r)
+{
+	return send_message(fd, r.success ? "1" : "0")
+		&& send_message(fd, r.success ? r.history : r.error)
+		&& send_message(fd, r.metrics);
+}
+
+bool recv_result(int fd, ReadylogPool::Result &r)
+{
+	string success;
+	string text;
+	if (!recv_message(fd, success) || !recv_message(fd, text) || !recv_message(fd, r.metrics))
+		return false;
+	r.success = success == "1";
+	(r.success ? r.history : r.error) = std::move(text);
+	return true;
+}
+
+ReadylogPool::Result error_result(const string &error)
+{ return ReadylogPool::Result { false, "", "", error }; }
+
+
+string errno_str(const string &what)
+{ return "ReadylogPool: " + what + ": " + ::strerror(errno); }
+
+
+
+/// Runs in a process forked from a worker, with the domain already compiled.
+void run_episode(const string &program_source, int fd)
+{
+	ReadylogPool::Result result;
+	try {
+		unique_ptr<Expression> parsed = parser::parse_string(program_source);
+		if (!parsed)
+			throw UserError("Failed to parse program");
+
+		ReadylogContext &ctx = ReadylogContext::instance();
+		Block program(new Scope(global_scope()), { parsed.release() });
+		History history = ctx.run(std::move(program));
+		result = ReadylogPool::Result {
+			true,
+			ctx.to_string(history.semantics().current_history()),
+			ctx.metrics().to_json(),
+			""
+		};
+	} catch (std::exception &e) {
+		result = error_result(e.what());
+	}
+	send_result(fd, result);
+}
+
+
+[[noreturn]] void worker_main(
+	int fd,
+	const string &domain_source,
+	const eclipse_opts &options,
+	const ReadylogPool::BackendFactory &backend_factory
+) {
+	// Synchronous, so that episode processes forked from here don't inherit a logger thread
+	Logger::instance().set_sink_after_fork(unique_ptr<LogSink>(new StreamSink(std::cerr)));
+
+	string init_error;
+	try {
+		// Only the declarations matter, the program block is discarded.
+		parser::parse_string(domain_source);
+		ReadylogContext::init(options, backend_factory ? backend_factory() : nullptr);
+		ReadylogContext::instance().implement_globals();
+	} catch (std::exception &e) {
+		init_error = e.what();
+	}
+
+	string program_source;
+	while (recv_message(fd, program_source)) {
+		if (!init_error.empty()) {
+			send_result(fd, error_result("Failed to initialize worker: " + init_error));
+			continue;
+		}
+
+		int episode_fds[2];
+		if (::socketpair(AF_UNIX, SOCK_STREAM, 0, episode_fds)) {
+			send_result(fd, error_result(errno_str("socketpair")));
+			continue;
+		}
+
+		pid_t pid = ::fork();
+		if (pid == 0) {
+			::close(fd);
+			::close(episode_fds[0]);
+			run_episode(program_source, episode_fds[1]);
+			::_exit(0);
+		}
+		::close(episode_fds[1]);
+
+		ReadylogPool::Result result;
+		if (pid < 0)
+			result = error_result(errno_str("fork"));
+		else if (!recv_result(episode_fds[0], result)) {
+			int status = 0;
+			::waitpid(pid, &status, 0);
+			pid = -1;
+			result = error_result("Episode process died"
+				+ (WIFSIGNALED(status) ? " from signal " + std::to_string(WTERMSIG(status)) : string())
+			);
+		}
+		::close(episode_fds[0]);
+		if (pid > 0)
+			::waitpid(pid, nullptr, 0);
+
+		if (!send_result(fd, result))
+			break;
+	}
+
+	::_exit(init_error.empty() ? 0 : 1);
+}
+
+
+} // namespace
+
+
+
+ReadylogPool::ReadylogPool(
+	size_t workers,
+	const string &domain_source,
+	const eclipse_opts &options,
+	BackendFactory backend_factory
+)
+: alive_(0)
+, running_(true)
+{
+	// Fork all workers before starting any threads
+	for (size_t i = 0; i < std::max(workers, size_t(1)); ++i) {
+		int fds[2];
+		if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds))
+			throw EngineError(errno_str("socketpair"));
+
+		pid_t pid = ::fork();
+		if (pid < 0)
+			throw EngineError(errno_str("fork"));
+		else if (pid == 0) {
+			// Don't keep the other workers' sockets open, so they see EOF when the pool closes them
+			for (unique_ptr<Worker> &w : workers_)
+				::close(w->fd);
+			::close(fds[0]);
+			worker_main(fds[1], domain_source, options, backend_factory);
+		}
+
+		::close(fds[1]);
+		workers_.emplace_back(new Worker { pid, fds[0], std::thread() });
+	}
+
+	alive_ = workers_.size();
+	for (unique_ptr<Worker> &w : workers_)
+		w->dispatcher = std::thread(&ReadylogPool::dispatch, this, std::ref(*w));
+}
+
+
+ReadylogPool::~ReadylogPool()
+{
+	{
+		std::lock_guard<std::mutex> locked(mutex_);
+		running_ = false;
+	}
+	cond_.notify_all();
+
+	for (unique_ptr<Worker> &w : workers_) {
+		w->dispatcher.join();
+		::close(w->fd);
+		::waitpid(w->pid, nullptr, 0);
+	}
+}
+
+
+std::future<ReadylogPool::Result> ReadylogPool::run(const string &program_source)
+{
+	Request request { program_source, std::promise<Result>() };
+	std::future<Result> rv = request.result.get_future();
+
+	{
+		std::lock_guard<std::mutex> locked(mutex_);
+		if (alive_ == 0)
+			request.result.set_value(error_result("ReadylogPool: All workers have died"));
+		else
+			requests_.push_back(std::move(request));
+	}
+	cond_.notify_one();
+
+	return rv;
+}
+
+
+size_t ReadylogPool::workers() const
+{ return workers_.size(); }
+
+
+void ReadylogPool::dispatch(Worker &worker)
+{
+	std::unique_lock<std::mutex> locked(mutex_);
+	for (;;) {
+		cond_.wait(locked, [&] { return !requests_.empty() || !running_; });
+		if (requests_.empty())
+			return;
+
+		Request request = std::move(requests_.front());
+		requests_.pop_front();
+		locked.unlock();
+
+		Result result;
+		bool alive = send_message(worker.fd, request.program_source) && recv_result(worker.fd, result);
+		if (!alive)
+			result = error_result("ReadylogPool: Worker process " + std::to_string(worker.pid) + " died");
+		request.result.set_value(std::move(result));
+
+		locked.lock();
+		if (!alive) {
+			if (--alive_ == 0)
+				fail_queued("ReadylogPool: All workers have died");
+			return;
+		}
+	}
+}
+
+
+void ReadylogPool::fail_queued(const string &error)
+{
+	for (Request &r : requests_)
+		r.result.set_value(error_result(error));
+	requests_.clear();
+}
+
+
+
+} // namespace gologpp
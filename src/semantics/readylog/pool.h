@@ -0,0 +1,88 @@
+#ifndef READYLOG_POOL_H_
+#define READYLOG_POOL_H_
+
+#include "execution.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include <sys/types.h>
+
+namespace gologpp {
+
+
+/**
+ * @brief Runs golog++ programs on K ReadyLog engines in parallel.
+ *
+ * ECLiPSe can only be embedded once per process, so every engine lives in a worker process that is
+ * forked when the pool is constructed. Each worker parses the domain, initializes its own
+ * @ref ReadylogContext and compiles the domain once. Then it forks a fresh episode process for
+ * every request, so episodes start from the same compiled domain and can't affect each other.
+ * Requests and results are passed over a UNIX socket pair per worker.
+ *
+ * Construct the pool before this process starts any threads or initializes ECLiPSe itself,
+ * since only the forking thread survives in the workers.
+ */
+class ReadylogPool {
+public:
+	using BackendFactory = std::function<unique_ptr<PlatformBackend> ()>;
+
+	struct Result {
+		bool success;
+		string history; ///< Final ReadyLog history term if successful
+		string metrics; ///< ExecutionMetrics as JSON if successful
+		string error; ///< Error message otherwise
+	};
+
+	/**
+	 * @param domain_source golog++ source code with all declarations. Like any golog++ source it must
+	 *        end in a program block, which the pool ignores.
+	 * @param backend_factory Makes the platform backend of each episode. Defaults to a @ref DummyBackend.
+	 */
+	ReadylogPool(
+		size_t workers,
+		const string &domain_source,
+		const eclipse_opts &options = eclipse_opts(),
+		BackendFactory backend_factory = nullptr
+	);
+	ReadylogPool(const ReadylogPool &) = delete;
+	~ReadylogPool();
+
+	/// Run the program block @param program_source against the domain on the next idle worker.
+	std::future<Result> run(const string &program_source);
+
+	size_t workers() const;
+
+private:
+	struct Worker {
+		pid_t pid;
+		int fd;
+		std::thread dispatcher;
+	};
+
+	struct Request {
+		string program_source;
+		std::promise<Result> result;
+	};
+
+	void dispatch(Worker &worker);
+	void fail_queued(const string &error);
+
+	vector<unique_ptr<Worker>> workers_;
+
+	std::mutex mutex_;
+	std::condition_variable cond_;
+	std::deque<Request> requests_;
+	size_t alive_;
+	bool running_;
+};
+
+
+
+} // namespace gologpp
+
+#endif // READYLOG_POOL_H_
@@ -48,8 +48,8 @@ EC_word Semantics<Value>::plterm()
 		EC_word list = ::nil();
 
 		const ListType::Representation &list_repr = static_cast<const ListType::Representation &>(value_);
-		ListType::Representation::const_reverse_iterator it = list_repr.rbegin();
-		while (it != list_repr.rend())
+		auto it = list_repr->rbegin();
+		while (it != list_repr->rend())
 			list = ::list((*it++)->semantics().plterm(), list);
 		return ::term(EC_functor("gpp_list", 2),
 			EC_atom(("#" + dynamic_cast<const ListType &>(value_.type()).element_type().name()).c_str()),
@@ -9,6 +9,7 @@
 #include <model/effect_axiom.h>
 #include <model/fluent.h>
 #include <model/procedural.h>
+#include <model/simplification.h>
 
 #ifdef GOLOGPP_TEST_READYLOG
 #include <semantics/readylog/execution.h>
@@ -39,8 +40,8 @@ void test_objectmodel()
 			on_scope->lookup_vars({"X"})
 		);
 		InitialValue *iv1 = new InitialValue {
-			{ new Constant(NumberType::name(), 1) },
-			new Constant(NumberType::name(), 0)
+			vector<Value *> { new Value(NumberType::name(), 1) },
+			new Value(NumberType::name(), 0)
 		};
 		on->define({iv1});
 		global_scope().register_global(on);
@@ -49,17 +50,16 @@ void test_objectmodel()
 
 	{
 		Scope *act_scope = new Scope(global_scope());
-		Action *put = new Action(act_scope, "", "put", {});
-		put->set_args( {
-			put->scope().get_var(VarDefinitionMode::FORCE, NumberType::name(), "X"),
-			put->scope().get_var(VarDefinitionMode::FORCE, NumberType::name(), "Y")
+		Action *put = new Action(act_scope, "", "put", {
+			act_scope->get_var(VarDefinitionMode::FORCE, NumberType::name(), "X"),
+			act_scope->get_var(VarDefinitionMode::FORCE, NumberType::name(), "Y")
 		});
 		global_scope().register_global(put);
 
 		put->set_precondition(new Comparison(
-			on->make_ref({ put->arg_ref("X") }),
+			on->make_ref({ put->param_ref("X") }),
 			ComparisonOperator::NEQ,
-			put->arg_ref("Y")
+			put->param_ref("Y")
 		));
 	}
 	shared_ptr<Action> put = global_scope().lookup_global<Action>("put", 2);
@@ -67,11 +67,11 @@ void test_objectmodel()
 	{ vector<unique_ptr<Expression>> arg;
 		EffectAxiom<Reference<Fluent>> *effect = new EffectAxiom<Reference<Fluent>>();
 		effect->define(
-			new Constant(BoolType::name(), true),
+			new Value(BoolType::name(), true),
 			on->make_ref({
-				put->arg_ref("X")
+				put->param_ref("X")
 			} ),
-			put->arg_ref("Y")
+			put->param_ref("Y")
 		);
 
 		put->add_effect(effect);
@@ -85,7 +85,7 @@ void test_objectmodel()
 		options.guitrace = false;
 
 		Block main(new Scope(global_scope()), {
-			put->make_ref({new Constant(NumberType::name(), 1), new Constant(NumberType::name(), 2)})
+			put->make_ref({new Value(NumberType::name(), 1), new Value(NumberType::name(), 2)})
 		});
 
 		ReadylogContext::init(options);
@@ -105,7 +105,13 @@ void test_objectmodel()
 void test_parser()
 {
 #ifdef GOLOGPP_TEST_PARSER
-	Expression *mainproc = parser::parse_file(SOURCE_DIR "/examples/blocksworld.gpp").release();
+	unique_ptr<Expression> parsed = parser::parse_file(SOURCE_DIR "/examples/blocksworld.gpp");
+
+	Simplification simplification = simplify(global_scope(), parsed);
+	std::cout << "Simplified " << simplification.size() << " expressions:" << std::endl
+		<< simplification.to_string("  ");
+
+	Expression *mainproc = parsed.release();
 
 	for (shared_ptr<const Global> g : global_scope().globals())
 		std::cout << g->str() << std::endl;